@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/utility.hpp>
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+#include <opencv2/videoio.hpp>
+
+#include <bananas_aruco/app_support/app_support.h>
+#include <bananas_aruco/camera_config.h>
+#include <bananas_aruco/detector_config.h>
+#include <bananas_aruco/pixel_format.h>
+#include <bananas_aruco/world.h>
+
+namespace {
+
+namespace app_support = bananas::app_support;
+namespace camera_config = bananas::camera_config;
+namespace detector_config = bananas::detector_config;
+namespace pixel_format = bananas::pixel_format;
+namespace world = bananas::world;
+
+const char *const about{
+    "Find the camera location in each frame of several recorded videos"};
+const char *const keys{
+    "{@videos  | <none> | Comma-separated input videos }"
+    "{camera   | <none> | JSON file containing the camera information }"
+    "{env      |        | JSON file describing the static environment }"
+    "{boards   |        | JSON file containing the board descriptions }"
+    "{database |        | Board database compiled by compile_boards, used "
+    "instead of -boards and -env }"
+    "{o        | .      | Output directory for the per-video JSON lines "
+    "files }"
+    "{threads  | 0      | Number of worker threads, 0 for one per core }"};
+
+/// Everything the videos have in common.
+struct Setup {
+    cv::Mat camera_matrix;
+    cv::Mat distortion_coefficients;
+    detector_config::DetectorConfig detector;
+    std::shared_ptr<const world::WorldModel> model;
+};
+
+/// How the processing of one video went.
+struct VideoSummary {
+    bool opened{false};
+    std::size_t frames{0};
+    std::size_t located_frames{0};
+};
+
+auto frame_json(const world::FitResult &result, std::size_t frame,
+               double timestamp_ms) -> nlohmann::json {
+    nlohmann::json json{{"frame", frame}, {"timestamp_ms", timestamp_ms}};
+    if (result.camera_to_world) {
+        json["camera_to_world"] = result.camera_to_world->placement;
+        json["reprojection_error"] =
+            result.camera_to_world->reprojection_error;
+    }
+    json["dynamic_boards"] = result.dynamic_board_placements;
+    return json;
+}
+
+/// Run World::fit() on every frame of @p video_file and write the results to
+/// @p output as JSON lines. The tracking state belongs to this video alone,
+/// while the model is shared with the other videos.
+auto process_video(const Setup &setup, const std::string &video_file,
+                   std::ostream &output, world::FitWorkspace &workspace)
+    -> VideoSummary {
+    VideoSummary summary{};
+    cv::VideoCapture capture{video_file};
+    if (!capture.isOpened()) {
+        return summary;
+    }
+    summary.opened = true;
+
+    world::World world{setup.model, setup.camera_matrix,
+                       setup.distortion_coefficients, setup.detector};
+    world::FitResult result{};
+    cv::Mat image{};
+    while (capture.read(image)) {
+        const double timestamp_ms{capture.get(cv::CAP_PROP_POS_MSEC)};
+        world.fit(image, pixel_format::PixelFormat::bgr, workspace, result);
+        if (result.camera_to_world) {
+            ++summary.located_frames;
+        }
+        output << frame_json(result, summary.frames, timestamp_ms) << '\n';
+        ++summary.frames;
+    }
+    return summary;
+}
+
+} // namespace
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+auto main(int argc, char *argv[]) -> int {
+    cv::CommandLineParser parser{argc, argv, keys};
+    parser.about(about);
+
+    const auto video_files{app_support::split(parser.get<std::string>(0))};
+    const auto camera_file{parser.get<std::string>("camera")};
+    const auto static_environment_file{parser.get<std::string>("env")};
+    const auto board_file{parser.get<std::string>("boards")};
+    const auto database_file{parser.get<std::string>("database")};
+    const std::filesystem::path out_dir{parser.get<std::string>("o")};
+    auto thread_count{parser.get<unsigned int>("threads")};
+    if (!parser.check()) {
+        parser.printErrors();
+        parser.printMessage();
+        return EXIT_FAILURE;
+    }
+    if (database_file.empty() &&
+        (board_file.empty() || static_environment_file.empty())) {
+        std::cerr << "Give either -database or both -boards and -env\n";
+        return EXIT_FAILURE;
+    }
+    if (video_files.empty()) {
+        std::cerr << "Give at least one video\n";
+        return EXIT_FAILURE;
+    }
+    // Videos with the same name in different directories would overwrite
+    // each other's results.
+    std::vector<std::filesystem::path> output_files{};
+    output_files.reserve(video_files.size());
+    std::map<std::filesystem::path, std::string> output_videos{};
+    for (const auto &video_file : video_files) {
+        auto output_file{out_dir / std::filesystem::path{video_file}
+                                       .stem()
+                                       .concat(".jsonl")};
+        const auto [other, inserted] =
+            output_videos.emplace(output_file, video_file);
+        if (!inserted) {
+            std::cerr << "Both " << other->second << " and " << video_file
+                      << " would be written to " << output_file.string()
+                      << ", rename one of them\n";
+            return EXIT_FAILURE;
+        }
+        output_files.push_back(std::move(output_file));
+    }
+    if (thread_count == 0) {
+        thread_count = std::max(1U, std::thread::hardware_concurrency());
+    }
+    thread_count = std::min(thread_count,
+                            static_cast<unsigned int>(video_files.size()));
+
+    // The model keeps a pointer to the dictionary, so it must outlive all
+    // the Worlds.
+    const auto dictionary{
+        cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_100)};
+    Setup setup{};
+    try {
+        std::ifstream camera_stream{camera_file};
+        if (!camera_stream) {
+            std::cerr << "Failed to open camera information file\n";
+            return EXIT_FAILURE;
+        }
+        const auto json = nlohmann::json::parse(camera_stream);
+        const auto camera{json.get<camera_config::CameraConfiguration>()};
+        setup.camera_matrix = camera_config::camera_matrix(camera);
+        setup.distortion_coefficients =
+            camera_config::distortion_coefficients(camera);
+        const auto detector_json{json.find("detector")};
+        if (detector_json != json.end()) {
+            detector_json->get_to(setup.detector);
+        }
+
+        // Build the model once. After this, it's only read.
+        setup.model = app_support::load_model(
+            dictionary, board_file, static_environment_file, database_file);
+    } catch (const std::exception &e) {
+        std::cerr << "Failed to read the configuration: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    std::cerr << "Processing " << video_files.size() << " videos with "
+              << thread_count << " threads\n";
+    std::vector<VideoSummary> summaries(video_files.size());
+    std::atomic<std::size_t> next{0};
+    std::vector<std::thread> workers{};
+    try {
+        for (unsigned int i{0}; i < thread_count; ++i) {
+            workers.emplace_back([&] {
+                // OpenCV's own threads would only fight with ours.
+                cv::setNumThreads(1);
+                world::FitWorkspace workspace{};
+                for (auto video{next++}; video < video_files.size();
+                     video = next++) {
+                    std::ofstream output{output_files[video]};
+                    if (output) {
+                        summaries[video] = process_video(
+                            setup, video_files[video], output, workspace);
+                    }
+                }
+            });
+        }
+    } catch (const std::exception &e) {
+        // Let the workers that did start finish the job.
+        std::cerr << "Failed to start all worker threads: " << e.what()
+                  << '\n';
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    if (workers.empty()) {
+        return EXIT_FAILURE;
+    }
+
+    bool all_ok{true};
+    for (std::size_t i{0}; i < video_files.size(); ++i) {
+        const auto &summary{summaries[i]};
+        if (!summary.opened) {
+            std::cerr << "Failed to process " << video_files[i] << '\n';
+            all_ok = false;
+            continue;
+        }
+        std::cout << video_files[i] << ": located the camera in "
+                  << summary.located_frames << " of " << summary.frames
+                  << " frames\n";
+    }
+    return all_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,114 @@
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <opencv2/core/utility.hpp>
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/board.h>
+#include <bananas_aruco/board_database.h>
+#include <bananas_aruco/concrete_board.h>
+#include <bananas_aruco/world.h>
+
+namespace {
+
+namespace board = bananas::board;
+namespace board_database = bananas::board_database;
+namespace world = bananas::world;
+
+const char *const about{
+    "Compile the board and static environment files into a binary board "
+    "database that loads quickly"};
+const char *const keys{
+    "{env    | <none>     | JSON file describing the static environment }"
+    "{boards | <none>     | JSON file containing the board descriptions }"
+    "{o      | boards.bin | Output file for the board database }"};
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+    cv::CommandLineParser parser{argc, argv, keys};
+    parser.about(about);
+
+    const auto static_environment_file{parser.get<std::string>("env")};
+    const auto board_file{parser.get<std::string>("boards")};
+    const auto output_file{parser.get<std::string>("o")};
+    if (!parser.check()) {
+        parser.printErrors();
+        parser.printMessage();
+        return EXIT_FAILURE;
+    }
+
+    std::vector<board::Board> boards{};
+    board_database::StaticPlacements static_placements{};
+    std::uint64_t checksum{0};
+    try {
+        // The boards first, then the environment. The positioners check the
+        // files in the same order.
+        const std::array sources{board_file, static_environment_file};
+        checksum = board_database::source_checksum(sources);
+
+        std::ifstream board_stream{board_file};
+        const auto concrete_boards{
+            nlohmann::json::parse(board_stream)
+                .get<std::vector<board::ConcreteBoard>>()};
+        boards.reserve(concrete_boards.size());
+        for (const auto &concrete_board : concrete_boards) {
+            std::visit(
+                [&boards](const auto &settings) {
+                    boards.push_back(board::make_board(settings));
+                },
+                concrete_board);
+        }
+
+        std::ifstream static_env_stream{static_environment_file};
+        world::BoardPlacement static_environment{};
+        world::from_json(nlohmann::json::parse(static_env_stream),
+                         static_environment);
+        for (const auto &[id, placement] : static_environment) {
+            if (id >= boards.size()) {
+                throw std::invalid_argument{
+                    "Static placement for unknown board " +
+                    std::to_string(id)};
+            }
+            static_placements.emplace_back(id, placement);
+        }
+
+        // Catch clashing marker IDs now rather than on the drone.
+        const auto dictionary{
+            cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_100)};
+        world::WorldModel model{dictionary};
+        for (const auto &compiled_board : boards) {
+            model.addBoard(compiled_board);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Failed to read the configuration: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    std::ofstream output{output_file, std::ios::binary};
+    if (!output) {
+        std::cerr << "Failed to open output file\n";
+        return EXIT_FAILURE;
+    }
+    board_database::write(output, boards, static_placements, checksum);
+    output.close();
+    if (!output) {
+        std::cerr << "Failed to write the board database\n";
+        return EXIT_FAILURE;
+    }
+    std::cerr << "Compiled " << boards.size() << " boards, "
+              << static_placements.size() << " of them static\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,326 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/utility.hpp>
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+#include <opencv2/videoio.hpp>
+
+#include <mavsdk/component_type.h>
+#include <mavsdk/connection_result.h>
+#include <mavsdk/mavsdk.h>
+#include <mavsdk/plugins/mocap/mocap.h>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/app_support/app_support.h>
+#include <bananas_aruco/camera_config.h>
+#include <bananas_aruco/channel.h>
+#include <bananas_aruco/detector_config.h>
+#include <bananas_aruco/frame_scheduler.h>
+#include <bananas_aruco/fusion.h>
+#include <bananas_aruco/mavlink.h>
+#include <bananas_aruco/pixel_format.h>
+#include <bananas_aruco/pose_predictor.h>
+#include <bananas_aruco/world.h>
+
+namespace {
+
+namespace affine_rotation = bananas::affine_rotation;
+namespace app_support = bananas::app_support;
+namespace camera_config = bananas::camera_config;
+namespace channel = bananas::channel;
+namespace detector_config = bananas::detector_config;
+namespace frame_scheduler = bananas::frame_scheduler;
+namespace fusion = bananas::fusion;
+namespace pixel_format = bananas::pixel_format;
+namespace pose_predictor = bananas::pose_predictor;
+namespace world = bananas::world;
+
+const char *const about{
+    "Find the drone location from the videos of several cameras on it"};
+const char *const keys{
+    "{@videos  | <none> | Comma-separated input videos or camera devices, "
+    "one per camera }"
+    "{cameras  | <none> | Comma-separated JSON files containing the camera "
+    "information, one per camera }"
+    "{env      |        | JSON file describing the static environment }"
+    "{boards   |        | JSON file containing the board descriptions }"
+    "{database |        | Board database compiled by compile_boards, used "
+    "instead of -boards and -env }"
+    "{mavlink  |        | Mavlink URL. Without one, the fused poses are "
+    "printed as JSON lines }"
+    "{rate     | 50     | Send at most this many pose estimates per second }"
+    "{predict  |        | Extrapolate poses between frames to send estimates "
+    "at a fixed rate }"
+    "{latency  | 100    | Skip video frames that fall behind by more than "
+    "this many milliseconds }"
+    "{skew     | 30     | Fuse camera frames captured at most this many "
+    "milliseconds apart }"};
+
+/// The World::fit() result of a frame of camera number @p camera.
+struct CameraFitResult {
+    std::size_t camera;
+    world::FitResult fit_result;
+};
+
+/// One of the cameras on the drone, with a World of its own so that the
+/// cameras can be processed in parallel. The Worlds share one model.
+struct Camera {
+    Camera(std::shared_ptr<const world::WorldModel> model,
+           const cv::Mat &camera_matrix, const cv::Mat &distortion,
+           const detector_config::DetectorConfig &detector,
+           std::chrono::milliseconds latency_budget)
+        : world{std::move(model), camera_matrix, distortion, detector},
+          scheduler{latency_budget} {}
+
+    world::World world;
+    cv::VideoCapture capture{};
+    frame_scheduler::FrameScheduler scheduler;
+    /// Frames that were fresh when captured would still go stale waiting
+    /// behind a slow fit, so fitting always takes the latest one.
+    channel::Channel<app_support::CapturedFrame> frames{
+        1, channel::OverflowPolicy::drop_oldest};
+};
+
+/// Set when the user asks the positioner to quit.
+std::atomic<bool> stop_requested{false};
+
+void request_stop(int /*signal*/) { stop_requested = true; }
+
+/// Run World::fit() on every frame of camera number @p index and pass the
+/// results on to @p results.
+void fit_frames(Camera &camera, std::size_t index,
+                channel::Channel<CameraFitResult> &results) {
+    world::FitWorkspace workspace{};
+    while (const auto frame{camera.frames.pop()}) {
+        CameraFitResult result{index, {}};
+        camera.world.fit(frame->image, pixel_format::PixelFormat::bgr,
+                         frame->capture_time, workspace, result.fit_result);
+        if (!results.push(std::move(result))) {
+            break;
+        }
+    }
+}
+
+} // namespace
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+auto main(int argc, char *argv[]) -> int {
+    cv::CommandLineParser parser{argc, argv, keys};
+    parser.about(about);
+
+    const auto video_files{app_support::split(parser.get<std::string>(0))};
+    const auto camera_files{
+        app_support::split(parser.get<std::string>("cameras"))};
+    const auto static_environment_file{parser.get<std::string>("env")};
+    const auto board_file{parser.get<std::string>("boards")};
+    const auto database_file{parser.get<std::string>("database")};
+    const auto send_rate{parser.get<double>("rate")};
+    const bool predict{parser.has("predict")};
+    const std::chrono::milliseconds latency_budget{
+        parser.get<int>("latency")};
+    const std::chrono::milliseconds max_skew{parser.get<int>("skew")};
+    if (!parser.check()) {
+        parser.printErrors();
+        parser.printMessage();
+        return EXIT_FAILURE;
+    }
+    if (database_file.empty() &&
+        (board_file.empty() || static_environment_file.empty())) {
+        std::cerr << "Give either -database or both -boards and -env\n";
+        return EXIT_FAILURE;
+    }
+    if (video_files.empty() || video_files.size() != camera_files.size()) {
+        std::cerr << "Give one camera file for each video\n";
+        return EXIT_FAILURE;
+    }
+    if (!(send_rate > 0.0) || latency_budget.count() < 0 ||
+        max_skew.count() < 0) {
+        std::cerr << "The rate must be positive and the times non-negative\n";
+        return EXIT_FAILURE;
+    }
+    const auto min_send_interval{
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>{1.0 / send_rate})};
+
+    const auto dictionary{
+        cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_100)};
+    std::vector<std::unique_ptr<Camera>> cameras{};
+    std::vector<affine_rotation::AffineRotation> camera_to_drone{};
+    try {
+        const auto model{app_support::load_model(
+            dictionary, board_file, static_environment_file, database_file)};
+
+        for (const auto &camera_file : camera_files) {
+            std::ifstream camera_stream{camera_file};
+            if (!camera_stream) {
+                std::cerr << "Failed to open camera information file "
+                          << camera_file << '\n';
+                return EXIT_FAILURE;
+            }
+            const auto json = nlohmann::json::parse(camera_stream);
+            const auto camera_info{
+                json.get<camera_config::CameraConfiguration>()};
+            detector_config::DetectorConfig detector{};
+            const auto detector_json{json.find("detector")};
+            if (detector_json != json.end()) {
+                detector_json->get_to(detector);
+            }
+
+            cameras.push_back(std::make_unique<Camera>(
+                model, camera_config::camera_matrix(camera_info),
+                camera_config::distortion_coefficients(camera_info), detector,
+                latency_budget));
+            camera_to_drone.push_back(camera_info.camera_to_drone);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Failed to read the configuration: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    mavsdk::Mavsdk mavsdk{mavsdk::Mavsdk::Configuration{
+        mavsdk::ComponentType::CompanionComputer}};
+    std::optional<mavsdk::Mocap> mocap{};
+    if (parser.has("mavlink")) {
+        const auto mavlink_url{parser.get<std::string>("mavlink")};
+        const auto connection_result{mavsdk.add_any_connection(mavlink_url)};
+        if (connection_result != mavsdk::ConnectionResult::Success) {
+            std::cerr << "Failed to open MAVLink connection: "
+                      << connection_result << '\n';
+            return EXIT_FAILURE;
+        }
+        std::cerr << "Waiting until a MAV system is detected\n";
+        while (mavsdk.systems().empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{100});
+        }
+        mocap.emplace(mavsdk.systems().at(0));
+    }
+    std::optional<bananas::mavlink::PoseSender> sender{};
+    if (mocap) {
+        sender.emplace(app_support::send_reporting_failures(*mocap),
+                       min_send_interval);
+    }
+    std::optional<pose_predictor::PosePredictor> predictor{};
+    if (sender && predict) {
+        predictor.emplace();
+    }
+
+    for (std::size_t i{0}; i < cameras.size(); ++i) {
+        if (!cameras[i]->capture.open(video_files[i])) {
+            std::cerr << "Failed to open " << video_files[i] << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Each camera gets a capture and a detection thread, and the results of
+    // all cameras meet on the main thread for fusion.
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+    channel::Channel<CameraFitResult> results{2 * cameras.size(),
+                                              channel::OverflowPolicy::block};
+    std::atomic<std::size_t> running_cameras{cameras.size()};
+    std::vector<std::thread> threads{};
+    for (std::size_t i{0}; i < cameras.size(); ++i) {
+        auto &camera{*cameras[i]};
+        threads.emplace_back([&camera] {
+            app_support::capture_frames(camera.capture, &camera.scheduler,
+                                        stop_requested, camera.frames);
+        });
+        threads.emplace_back([&camera, i, &results, &running_cameras] {
+            fit_frames(camera, i, results);
+            if (--running_cameras == 0) {
+                results.close();
+            }
+        });
+    }
+    std::thread stream_thread{};
+    // The fused poses are those of the drone itself.
+    const affine_rotation::AffineRotation drone_to_drone{};
+    if (predictor) {
+        stream_thread = std::thread{[&predictor, &drone_to_drone,
+                                     min_send_interval, &sender] {
+            app_support::stream_poses(*predictor, drone_to_drone,
+                                      min_send_interval, stop_requested,
+                                      *sender);
+        }};
+    }
+
+    fusion::Fuser fuser{camera_to_drone, max_skew};
+    fusion::FusedResult fused{};
+    std::optional<fusion::Clock::time_point> last_capture_time{};
+    auto next_report{std::chrono::steady_clock::now() +
+                     app_support::age_report_interval};
+    while (const auto result{results.pop()}) {
+        fuser.update(result->camera, result->fit_result, fused);
+        // A slower camera can finish an older frame after a faster one has
+        // finished a newer one. PX4 expects the poses in chronological
+        // order, so drop the ones that would go back in time.
+        if (last_capture_time && fused.capture_time <= *last_capture_time) {
+            continue;
+        }
+        last_capture_time = fused.capture_time;
+        if (fused.drone_to_world && predictor) {
+            predictor->update(*fused.drone_to_world, fused.capture_time);
+        } else if (fused.drone_to_world && sender) {
+            sender->post(bananas::mavlink::drone_position_estimate(
+                drone_to_drone, *fused.drone_to_world, fused.capture_time));
+        } else if (fused.drone_to_world) {
+            const nlohmann::json pose{
+                {"capture_time_us",
+                 bananas::mavlink::timestamp_usec(fused.capture_time)},
+                {"cameras", fused.camera_count},
+                {"drone_to_world", fused.drone_to_world->placement},
+                {"reprojection_error",
+                 fused.drone_to_world->reprojection_error},
+                {"dynamic_boards", fused.dynamic_board_placements}};
+            std::cout << pose << '\n';
+        }
+
+        if (sender && std::chrono::steady_clock::now() >= next_report) {
+            next_report += app_support::age_report_interval;
+            const auto ages{sender->takeAges()};
+            if (ages.count() > 0) {
+                std::cerr << app_support::describe_ages(ages) << '\n';
+            }
+        }
+    }
+
+    stop_requested = true;
+    for (auto &camera : cameras) {
+        camera->frames.close();
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    if (stream_thread.joinable()) {
+        stream_thread.join();
+    }
+
+    for (std::size_t i{0}; i < cameras.size(); ++i) {
+        const auto statistics{cameras[i]->scheduler.statistics()};
+        std::cerr << "Camera " << i << " dropped "
+                  << statistics.dropped + cameras[i]->frames.dropped()
+                  << " of " << statistics.dropped + statistics.processed
+                  << " frames to keep up\n";
+    }
+    if (sender) {
+        const auto statistics{sender->statistics()};
+        std::cerr << "Sent " << statistics.sent << " pose estimates, "
+                  << statistics.coalesced << " were superseded before sending "
+                  << "and " << statistics.failed << " failed\n";
+    }
+}
@@ -1,23 +1,25 @@
+#include <chrono>
 #include <cmath>
 #include <cstdlib>
 #include <exception>
 #include <fstream>
-#include <initializer_list>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <utility>
 #include <variant>
 #include <vector>
 
 #ifdef ENABLE_ROS2
 #include <algorithm>
-#include <memory>
-#include <sstream>
 #else // ENABLE_ROS2
-#include <chrono>
-#include <cstdint>
-#include <optional>
-#include <thread>
+#include <atomic>
+#include <csignal>
+#include <cstddef>
 #endif // ENABLE_ROS2
 
 #ifdef ENABLE_ROS2
@@ -27,9 +29,12 @@
 
 #include <nlohmann/json.hpp>
 
+#include <opencv2/core/hal/interface.h>
 #include <opencv2/core/mat.hpp>
 #include <opencv2/core/utility.hpp>
+#ifdef ENABLE_VISUALIZER
 #include <opencv2/highgui.hpp>
+#endif // ENABLE_VISUALIZER
 #include <opencv2/objdetect/aruco_detector.hpp>
 #include <opencv2/objdetect/aruco_dictionary.hpp>
 #ifndef ENABLE_ROS2
@@ -37,12 +42,14 @@
 #endif // ENABLE_ROS2
 
 #ifdef ENABLE_ROS2
+#include <builtin_interfaces/msg/time.hpp>
 #include <cv_bridge/cv_bridge.hpp>
 #include <image_transport/image_transport.hpp>
 #include <image_transport/subscriber.hpp>
 #include <rclcpp/executors.hpp>
 #include <rclcpp/logging.hpp>
 #include <rclcpp/node.hpp>
+#include <rclcpp/time.hpp>
 #include <rclcpp/timer.hpp>
 #include <rclcpp/utilities.hpp>
 #include <rmw/qos_profiles.h>
@@ -56,45 +63,73 @@
 #include <mavsdk/plugins/mocap/mocap.h>
 
 #include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/app_support/app_support.h>
+#ifndef ENABLE_ROS2
+#include <bananas_aruco/channel.h>
+#endif // ENABLE_ROS2
+#include <bananas_aruco/camera_config.h>
 #include <bananas_aruco/concrete_board.h>
+#include <bananas_aruco/detector_config.h>
+#ifndef ENABLE_ROS2
+#include <bananas_aruco/frame_scheduler.h>
+#endif // ENABLE_ROS2
 #include <bananas_aruco/mavlink.h>
+#include <bananas_aruco/pixel_format.h>
+#include <bananas_aruco/pose_predictor.h>
+#include <bananas_aruco/profiling.h>
+#ifdef ENABLE_VISUALIZER
 #include <bananas_aruco/visualization/visualizer.h>
+#endif // ENABLE_VISUALIZER
 #include <bananas_aruco/world.h>
 
 namespace {
 
 namespace affine_rotation = bananas::affine_rotation;
+namespace app_support = bananas::app_support;
 namespace board = bananas::board;
+namespace camera_config = bananas::camera_config;
+namespace detector_config = bananas::detector_config;
+namespace pixel_format = bananas::pixel_format;
+namespace pose_predictor = bananas::pose_predictor;
+namespace profiling = bananas::profiling;
 namespace world = bananas::world;
+#ifdef ENABLE_VISUALIZER
 namespace visualizer = bananas::visualizer;
+#endif // ENABLE_VISUALIZER
 
 const char *const about{"Find camera and box locations from a video"};
 const char *const keys{
-    "{env     | <none> | JSON file describing the static environment }"
-    "{boards  | <none> | JSON file containing the board descriptions }"
-    "{camera  | <none> | JSON file containing the camera information }"
-    "{mavlink |        | Mavlink URL }"
+    "{env      |        | JSON file describing the static environment }"
+    "{boards   |        | JSON file containing the board descriptions }"
+    "{database |        | Board database compiled by compile_boards, used "
+    "instead of -boards and -env"
+#ifdef ENABLE_VISUALIZER
+    ". Requires -headless"
+#endif // ENABLE_VISUALIZER
+    " }"
+    "{camera   | <none> | JSON file containing the camera information }"
+    "{mavlink  |        | Mavlink URL }"
+    "{track    |        | Only search for markers near their last locations }"
+    "{pyramid  |        | Detect large markers on a downscaled image }"
+    "{detector |        | Detector preset name or JSON file, overriding the "
+    "detector settings in the camera file }"
+    "{profile  |        | Write World::fit() latency statistics to this JSON "
+    "file on exit }"
+#ifdef ENABLE_VISUALIZER
+    "{headless |        | Only estimate poses, without opening any windows }"
+#endif // ENABLE_VISUALIZER
+    "{rate     | 50     | Send at most this many pose estimates per second }"
+    "{predict  |        | Extrapolate poses between frames to send estimates "
+    "at a fixed rate }"
 #ifndef ENABLE_ROS2
-    "{@infile | <none> | Input video }"
-    "{vo      |        | Video output file }"
+    "{@infile  | <none> | Input video }"
+    "{vo       |        | Video output file }"
+    "{latency  | 100    | Skip video frames that fall behind by more than "
+    "this many milliseconds, unless writing a video }"
 #endif // ENABLE_ROS2
 };
 
-struct CameraConfiguration {
-    float focal_length_x{};
-    float focal_length_y{};
-    float optical_center_x{};
-    float optical_center_y{};
-    std::vector<float> distortion_coefficients{};
-    affine_rotation::AffineRotation camera_to_drone{};
-};
-
-// Mark to_json as potentially unused to make clang happy. This is ugly, but it
-// works.
-[[maybe_unused]] NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(
-    CameraConfiguration, focal_length_x, focal_length_y, optical_center_x,
-    optical_center_y, distortion_coefficients, camera_to_drone);
-
+#ifdef ENABLE_VISUALIZER
 /// Returns true if the user wants to exit the application. Handles pausing and
 /// blocks until the user unpauses.
 auto handle_keys() -> bool {
@@ -112,19 +147,71 @@ auto handle_keys() -> bool {
     } while (paused);
     return false;
 }
+#endif // ENABLE_VISUALIZER
 
 #ifdef ENABLE_ROS2
 
 const std::string node_name{"bananas_positioner"};
 const std::string image_topic{"aruco_camera/image"};
 
+/// Wrap the pixels of @p msg in a cv::Mat without copying them if
+/// World::fit() can use them as they are. Other encodings are converted to
+/// BGR.
+///
+/// @return std::nullopt if the message is malformed.
+auto image_view(const sensor_msgs::msg::Image::ConstSharedPtr &msg)
+    -> std::optional<std::pair<cv::Mat, pixel_format::PixelFormat>> {
+    namespace encodings = sensor_msgs::image_encodings;
+    if (msg->encoding == encodings::MONO8) {
+        return std::pair{cv_bridge::toCvShare(msg)->image,
+                         pixel_format::PixelFormat::gray};
+    }
+    if (msg->encoding == encodings::BGR8) {
+        return std::pair{cv_bridge::toCvShare(msg)->image,
+                         pixel_format::PixelFormat::bgr};
+    }
+    // cv_bridge doesn't know about the YUV 4:2:0 encodings, so wrap them by
+    // hand. The Y plane has one byte per pixel and the chroma samples follow
+    // it at the same stride.
+    const bool nv12{msg->encoding == "nv12"};
+    if (nv12 || msg->encoding == encodings::NV21) {
+        // Don't read past the end of a short buffer.
+        const std::size_t rows{std::size_t{msg->height} * 3 / 2};
+        if (msg->height % 2 != 0 || msg->step < msg->width ||
+            msg->data.size() < rows * msg->step) {
+            return std::nullopt;
+        }
+        // NOTE: The message outlives the callback's use of the image.
+        const cv::Mat image{
+            static_cast<int>(rows),
+            static_cast<int>(msg->width), CV_8UC1,
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+            const_cast<std::uint8_t *>(msg->data.data()), msg->step};
+        return std::pair{image, nv12 ? pixel_format::PixelFormat::nv12
+                                     : pixel_format::PixelFormat::nv21};
+    }
+    return std::pair{cv_bridge::toCvShare(msg, static_cast<const char *>(
+                                                   encodings::BGR8))
+                         ->image,
+                     pixel_format::PixelFormat::bgr};
+}
+
 class RosPositioner : public rclcpp::Node {
   public:
-    RosPositioner(world::World &world, visualizer::Visualizer &visualizer,
+#ifdef ENABLE_VISUALIZER
+    /// @p visualizer is null when running headless.
+    RosPositioner(world::World &world, visualizer::Visualizer *visualizer,
+#else
+    RosPositioner(world::World &world,
+#endif // ENABLE_VISUALIZER
                   std::shared_ptr<mavsdk::System> mav_system,
-                  affine_rotation::AffineRotation camera_to_drone)
+                  affine_rotation::AffineRotation camera_to_drone,
+                  std::chrono::steady_clock::duration min_send_interval,
+                  bool predict)
         : Node{node_name, rclcpp::NodeOptions{}}, world_{&world},
-          visualizer_{&visualizer},
+#ifdef ENABLE_VISUALIZER
+          visualizer_{visualizer},
+#endif // ENABLE_VISUALIZER
           image_sub_{image_transport::create_subscription(
               this, image_topic,
               [this](const auto &msg) { return imageCallback(msg); }, "raw",
@@ -132,16 +219,30 @@ class RosPositioner : public rclcpp::Node {
           camera_to_drone_{std::move(camera_to_drone)} {
         if (mav_system) {
             mocap_.emplace(mav_system);
+            sender_.emplace(
+                [this](const mavsdk::Mocap::VisionPositionEstimate &estimate) {
+                    return sendMocap(estimate);
+                },
+                min_send_interval);
             fake_mocap_timer_ = create_wall_timer(
                 std::chrono::milliseconds{20}, [this] { fakeTimerCallback(); });
             RCLCPP_INFO(this->get_logger(),
                         "Starting to send fake Mocap data.");
+            if (predict) {
+                predictor_.emplace();
+                stream_timer_ = create_wall_timer(
+                    min_send_interval, [this] { streamTimerCallback(); });
+            }
+            age_report_timer_ = create_wall_timer(
+                app_support::age_report_interval,
+                [this] { ageReportTimerCallback(); });
         }
     }
 
   private:
-    void
-    sendMocap(const mavsdk::Mocap::VisionPositionEstimate &estimate) const {
+    /// Runs on the thread of #sender_.
+    auto sendMocap(const mavsdk::Mocap::VisionPositionEstimate &estimate) const
+        -> mavsdk::Mocap::Result {
         Expects(mocap_);
         const auto result{mocap_->set_vision_position_estimate(estimate)};
         if (result != mavsdk::Mocap::Result::Success) {
@@ -150,54 +251,188 @@ class RosPositioner : public rclcpp::Node {
             RCLCPP_ERROR(get_logger(), "Failed to send Mocap data: %s",
                          ss.str().c_str());
         }
+        return result;
     }
 
-    void fakeTimerCallback() const {
+    void fakeTimerCallback() {
         mavsdk::Mocap::VisionPositionEstimate estimate{};
         const std::vector<float> covariance_matrix(21);
         estimate.pose_covariance = {covariance_matrix};
-        sendMocap(estimate);
+        sender_->post(std::move(estimate));
+    }
+
+    void streamTimerCallback() {
+        const auto now{pose_predictor::Clock::now()};
+        if (const auto camera_to_world{predictor_->predict(now)}) {
+            sender_->post(bananas::mavlink::drone_position_estimate(
+                camera_to_drone_, *camera_to_world, now));
+        }
+    }
+
+    void ageReportTimerCallback() {
+        const auto ages{sender_->takeAges()};
+        if (ages.count() > 0) {
+            RCLCPP_INFO(get_logger(), "%s",
+                        app_support::describe_ages(ages).c_str());
+        }
+    }
+
+    /// Translate the ROS time stamp of an image into the steady clock time
+    /// at which the camera captured it.
+    [[nodiscard]] auto captureTime(const builtin_interfaces::msg::Time &stamp)
+        const -> std::chrono::steady_clock::time_point {
+        const auto now{std::chrono::steady_clock::now()};
+        const rclcpp::Time stamp_time{stamp, get_clock()->get_clock_type()};
+        // Publishers that don't stamp their images leave the stamp at zero.
+        if (stamp_time.nanoseconds() == 0) {
+            return now;
+        }
+        const std::chrono::nanoseconds age{
+            (get_clock()->now() - stamp_time).nanoseconds()};
+        return now - std::max(age, std::chrono::nanoseconds::zero());
     }
 
     void imageCallback(const sensor_msgs::msg::Image::ConstSharedPtr &msg) {
-        const cv::Mat image{
-            cv_bridge::toCvShare(msg, static_cast<const char *>(
-                                          sensor_msgs::image_encodings::BGR8))
-                ->image};
-        const auto fit_result{world_->fit(image)};
+        const auto capture_time{captureTime(msg->header.stamp)};
+        std::optional<std::pair<cv::Mat, pixel_format::PixelFormat>> view{};
+        try {
+            view = image_view(msg);
+        } catch (const cv_bridge::Exception &e) {
+            RCLCPP_WARN(this->get_logger(), "Skipping image: %s", e.what());
+            return;
+        }
+        if (!view) {
+            RCLCPP_WARN(this->get_logger(),
+                        "Skipping malformed %s image of %u bytes",
+                        msg->encoding.c_str(),
+                        static_cast<unsigned int>(msg->data.size()));
+            return;
+        }
+        const auto &[image, format] = *view;
+        auto &fit_result{fit_result_};
+        world_->fit(image, format, capture_time, fit_workspace_, fit_result);
 
-        if (fit_result.camera_to_world && mocap_) {
+        if (fit_result.camera_to_world && sender_) {
             if (!fake_mocap_timer_->is_canceled()) {
                 RCLCPP_INFO(this->get_logger(),
                             "Found camera position. Stopping fake Mocap data.");
                 fake_mocap_timer_->cancel();
             }
-            const auto estimate{bananas::mavlink::drone_position_estimate(
-                camera_to_drone_, *fit_result.camera_to_world)};
-            sendMocap(estimate);
+            if (predictor_) {
+                predictor_->update(*fit_result.camera_to_world,
+                                   fit_result.capture_time);
+            } else {
+                sender_->post(bananas::mavlink::drone_position_estimate(
+                    camera_to_drone_, *fit_result.camera_to_world,
+                    fit_result.capture_time));
+            }
         }
 
+#ifdef ENABLE_VISUALIZER
+        if (visualizer_ == nullptr) {
+            return;
+        }
         visualizer_->update(fit_result);
         visualizer_->refresh();
 
         cv::Mat render_image{};
-        image.copyTo(render_image);
+        pixel_format::to_bgr(image, format, render_image);
         cv::aruco::drawDetectedMarkers(render_image, fit_result.corners,
                                        fit_result.ids);
         cv::imshow("out", render_image);
         if (handle_keys()) {
             rclcpp::shutdown();
         }
+#endif // ENABLE_VISUALIZER
     }
 
     gsl::not_null<world::World *> world_;
-    gsl::not_null<visualizer::Visualizer *> visualizer_;
+    world::FitWorkspace fit_workspace_{};
+    world::FitResult fit_result_{};
+#ifdef ENABLE_VISUALIZER
+    visualizer::Visualizer *visualizer_;
+#endif // ENABLE_VISUALIZER
     image_transport::Subscriber image_sub_;
     affine_rotation::AffineRotation camera_to_drone_{};
     std::optional<mavsdk::Mocap> mocap_{};
+    // Declared after mocap_ since it sends through it until destroyed.
+    std::optional<bananas::mavlink::PoseSender> sender_{};
     rclcpp::TimerBase::SharedPtr fake_mocap_timer_{};
+    std::optional<pose_predictor::PosePredictor> predictor_{};
+    rclcpp::TimerBase::SharedPtr stream_timer_{};
+    rclcpp::TimerBase::SharedPtr age_report_timer_{};
+};
+
+#else // ENABLE_ROS2
+
+namespace channel = bananas::channel;
+namespace frame_scheduler = bananas::frame_scheduler;
+
+/// A camera image together with the World::fit() result computed from it.
+struct FittedFrame {
+    cv::Mat image;
+    world::FitResult fit_result;
 };
 
+/// Run World::fit() on every frame from @p frames. Poses are fed to
+/// @p predictor if there is one, and otherwise posted to @p sender unless it
+/// is null. The ages of the sent estimates are reported periodically. All
+/// results are passed on to @p fitted_frames for visualization unless it is
+/// null.
+void fit_frames(world::World &world,
+                const affine_rotation::AffineRotation &camera_to_drone,
+                channel::Channel<app_support::CapturedFrame> &frames,
+                pose_predictor::PosePredictor *predictor,
+                bananas::mavlink::PoseSender *sender,
+                channel::Channel<FittedFrame> *fitted_frames) {
+    world::FitWorkspace workspace{};
+    world::FitResult fit_result{};
+    auto next_report{std::chrono::steady_clock::now() +
+                     app_support::age_report_interval};
+    while (auto frame{frames.pop()}) {
+        world.fit(frame->image, pixel_format::PixelFormat::bgr,
+                  frame->capture_time, workspace, fit_result);
+        if (fit_result.camera_to_world && predictor != nullptr) {
+            predictor->update(*fit_result.camera_to_world,
+                              fit_result.capture_time);
+        } else if (fit_result.camera_to_world && sender != nullptr) {
+            sender->post(bananas::mavlink::drone_position_estimate(
+                camera_to_drone, *fit_result.camera_to_world,
+                fit_result.capture_time));
+        }
+        if (sender != nullptr &&
+            std::chrono::steady_clock::now() >= next_report) {
+            next_report += app_support::age_report_interval;
+            const auto ages{sender->takeAges()};
+            if (ages.count() > 0) {
+                std::cerr << app_support::describe_ages(ages) << '\n';
+            }
+        }
+        // The result is handed over to the render loop, so it can only be
+        // reused if nobody is looking at it.
+        if (fitted_frames != nullptr &&
+            !fitted_frames->push(
+                {std::move(frame->image), std::exchange(fit_result, {})})) {
+            break;
+        }
+    }
+    if (fitted_frames != nullptr) {
+        fitted_frames->close();
+    }
+}
+
+/// Set when the user asks the positioner to quit.
+std::atomic<bool> stop_requested{false};
+
+void request_stop(int /*signal*/) { stop_requested = true; }
+
+// When recording, the frame queue only needs to cover the jitter between
+// decoding and fitting.
+constexpr std::size_t frame_queue_capacity{2};
+// Recording must not lose frames, but it shouldn't hold up fitting for long
+// either.
+constexpr std::size_t recording_queue_capacity{8};
+
 #endif // ENABLE_ROS2
 
 } // namespace
@@ -225,12 +460,27 @@ auto main(int argc, char *argv[]) -> int {
     const auto camera_file{parser.get<std::string>("camera")};
     const auto static_environment_file{parser.get<std::string>("env")};
     const auto board_file{parser.get<std::string>("boards")};
+    const auto database_file{parser.get<std::string>("database")};
+#ifdef ENABLE_VISUALIZER
+    const bool headless{parser.has("headless")};
+#else
+    // Built without the visualizer, the positioner never opens a window.
+    const bool headless{true};
+#endif // ENABLE_VISUALIZER
+    const auto send_rate{parser.get<double>("rate")};
+    const bool predict{parser.has("predict")};
+    std::optional<std::string> profile_file{};
+    if (parser.has("profile")) {
+        profile_file = parser.get<std::string>("profile");
+    }
 #ifndef ENABLE_ROS2
     const auto video_file{parser.get<std::string>(0)};
     std::optional<std::string> video_output_file{};
     if (parser.has("vo")) {
         video_output_file = parser.get<std::string>("vo");
     }
+    const std::chrono::milliseconds latency_budget{
+        parser.get<int>("latency")};
 #endif // ENABLE_ROS2
 
     if (!parser.check()) {
@@ -238,10 +488,29 @@ auto main(int argc, char *argv[]) -> int {
         parser.printMessage();
         return EXIT_FAILURE;
     }
+    if (!(send_rate > 0.0)) {
+        std::cerr << "The send rate must be positive\n";
+        return EXIT_FAILURE;
+    }
+    if (database_file.empty() &&
+        (board_file.empty() || static_environment_file.empty())) {
+        std::cerr << "Give either -database or both -boards and -env\n";
+        return EXIT_FAILURE;
+    }
+    // The 3D view draws the boards from their settings in the board file,
+    // which the database doesn't keep.
+    if (!database_file.empty() && !headless) {
+        std::cerr << "-database requires -headless\n";
+        return EXIT_FAILURE;
+    }
+    const auto min_send_interval{
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>{1.0 / send_rate})};
 
     cv::Mat camera_matrix{};
     cv::Mat distortion_coefficients{};
     affine_rotation::AffineRotation camera_to_drone{};
+    detector_config::DetectorConfig detector_settings{};
     {
         std::ifstream camera_info_stream{camera_file};
         if (!camera_info_stream) {
@@ -249,30 +518,45 @@ auto main(int argc, char *argv[]) -> int {
             return EXIT_FAILURE;
         }
 
-        CameraConfiguration camera_info;
+        camera_config::CameraConfiguration camera_info;
         try {
             const auto json = nlohmann::json::parse(camera_info_stream);
             json.get_to(camera_info);
+            const auto detector{json.find("detector")};
+            if (detector != json.end()) {
+                detector->get_to(detector_settings);
+            }
         } catch (const std::exception &e) {
             std::cerr << "Failed to parse camera information file: " << e.what()
                       << '\n';
             return EXIT_FAILURE;
         }
-        cv::Mat calibration_matrix{{3, 3},
-                                   std::initializer_list<float>{
-                                       camera_info.focal_length_x, 0,
-                                       camera_info.optical_center_x, 0,
-                                       camera_info.focal_length_y,
-                                       camera_info.optical_center_y, 0, 0, 1}};
-        cv::Mat distortion_mat{camera_info.distortion_coefficients, true};
-
-        camera_matrix = std::move(calibration_matrix);
-        distortion_coefficients = std::move(distortion_mat);
+        camera_matrix = camera_config::camera_matrix(camera_info);
+        distortion_coefficients =
+            camera_config::distortion_coefficients(camera_info);
         camera_to_drone = camera_info.camera_to_drone;
     }
 
+    if (parser.has("detector")) {
+        const auto detector{parser.get<std::string>("detector")};
+        try {
+            std::ifstream detector_stream{detector};
+            if (detector_stream) {
+                nlohmann::json::parse(detector_stream)
+                    .get_to(detector_settings);
+            } else {
+                detector_settings = detector_config::preset(detector);
+            }
+        } catch (const std::exception &e) {
+            std::cerr << "Invalid detector settings: " << e.what() << '\n';
+            return EXIT_FAILURE;
+        }
+    }
+
+    // With a database, the JSON files are only read to check that it is up
+    // to date.
     world::BoardPlacement static_environment{};
-    {
+    if (database_file.empty()) {
         std::ifstream static_env_stream{static_environment_file};
         if (!static_env_stream) {
             std::cerr << "Failed to open static environment file\n";
@@ -289,7 +573,7 @@ auto main(int argc, char *argv[]) -> int {
         }
     }
     std::vector<board::ConcreteBoard> boards{};
-    {
+    if (database_file.empty()) {
         std::ifstream board_stream{board_file};
         if (!board_stream) {
             std::cerr << "Failed to open board file\n";
@@ -327,35 +611,113 @@ auto main(int argc, char *argv[]) -> int {
 
     const auto dictionary{
         cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_100)};
-    world::World world{camera_matrix, distortion_coefficients, dictionary};
-    visualizer::Visualizer visualizer{};
-    for (const auto &board : boards) {
-        std::visit(
-            [&world, &visualizer](const auto &settings) {
-                const auto board_id{
-                    world.addBoard(board::make_board(settings))};
-                visualizer.addObject(board_id, settings);
-            },
-            board);
+#ifdef ENABLE_VISUALIZER
+    // Creating the visualizer opens its window, so only do it when needed.
+    std::optional<visualizer::Visualizer> visualizer{};
+    if (!headless) {
+        visualizer.emplace();
     }
+#endif // ENABLE_VISUALIZER
+    std::shared_ptr<const world::WorldModel> model{};
+    if (!database_file.empty()) {
+        try {
+            model = app_support::load_model(dictionary, board_file,
+                                            static_environment_file,
+                                            database_file);
+        } catch (const std::exception &e) {
+            std::cerr << "Failed to load the board database: " << e.what()
+                      << '\n';
+            return EXIT_FAILURE;
+        }
+    } else {
+        auto json_model{std::make_shared<world::WorldModel>(dictionary)};
+        try {
+            for (const auto &board : boards) {
+                std::visit(
+                    [&](const auto &settings) {
+                        [[maybe_unused]] const auto board_id{
+                            json_model->addBoard(board::make_board(settings))};
+#ifdef ENABLE_VISUALIZER
+                        if (visualizer) {
+                            visualizer->addObject(board_id, settings);
+                        }
+#endif // ENABLE_VISUALIZER
+                    },
+                    board);
+            }
+        } catch (const std::invalid_argument &e) {
+            std::cerr << "Invalid board file: " << e.what() << '\n';
+            return EXIT_FAILURE;
+        }
 
-    for (const auto &[id, placement] : static_environment) {
-        world.makeStatic(id, placement);
-        visualizer.update(id, placement);
-        visualizer.forceVisible(id);
+        std::vector<std::pair<world::BoardId, affine_rotation::AffineRotation>>
+            static_placements{};
+        static_placements.reserve(static_environment.size());
+        for (const auto &[id, placement] : static_environment) {
+            static_placements.emplace_back(id, placement);
+        }
+        try {
+            json_model->makeStatic(static_placements);
+        } catch (const std::invalid_argument &e) {
+            std::cerr << "Invalid static environment file: " << e.what()
+                      << '\n';
+            return EXIT_FAILURE;
+        }
+#ifdef ENABLE_VISUALIZER
+        if (visualizer) {
+            for (const auto &[id, placement] : static_environment) {
+                visualizer->update(id, placement);
+                visualizer->forceVisible(id);
+            }
+        }
+#endif // ENABLE_VISUALIZER
+        model = std::move(json_model);
+    }
+
+    world::World world{model, camera_matrix, distortion_coefficients,
+                       detector_settings};
+    if (parser.has("track")) {
+        world.enableTracking({});
+    }
+    if (parser.has("pyramid")) {
+        world.enablePyramid({});
+    }
+    if (profile_file && !profiling::enabled) {
+        std::cerr << "Not recording latencies: the positioner was built "
+                     "without WITH_PROFILING\n";
     }
 
-    cv::namedWindow("out", cv::WINDOW_NORMAL);
+#ifdef ENABLE_VISUALIZER
+    if (!headless) {
+        cv::namedWindow("out", cv::WINDOW_NORMAL);
+    }
+#endif // ENABLE_VISUALIZER
 
 #ifdef ENABLE_ROS2
+#ifdef ENABLE_VISUALIZER
+    const auto node{std::make_shared<RosPositioner>(
+        world, visualizer ? &*visualizer : nullptr, mav_system,
+        camera_to_drone, min_send_interval, predict)};
+#else
     const auto node{std::make_shared<RosPositioner>(
-        world, visualizer, mav_system, camera_to_drone)};
+        world, mav_system, camera_to_drone, min_send_interval, predict)};
+#endif // ENABLE_VISUALIZER
     rclcpp::spin(node);
     rclcpp::shutdown();
 #else
     std::optional<mavsdk::Mocap> mocap{};
+    // Sending runs on a thread of its own so that a stalled MAVLink
+    // connection never holds up fitting.
+    std::optional<bananas::mavlink::PoseSender> sender{};
     if (mav_system) {
         mocap.emplace(mav_system);
+        sender.emplace(app_support::send_reporting_failures(*mocap),
+                       min_send_interval);
+    }
+    // Without a connection there is nobody to stream the predictions to.
+    std::optional<pose_predictor::PosePredictor> predictor{};
+    if (sender && predict) {
+        predictor.emplace();
     }
 
     cv::VideoCapture capture{video_file};
@@ -368,44 +730,112 @@ auto main(int argc, char *argv[]) -> int {
                      static_cast<int>(capture.get(cv::CAP_PROP_FRAME_HEIGHT))});
     }
 
-    cv::Mat image{};
-    cv::Mat render_image{};
-    const auto start_time{std::chrono::system_clock::now()};
-    while (capture.isOpened()) {
-        const bool got_frame{capture.read(image)};
-        if (!got_frame) {
-            break;
-        }
+    // Each stage runs on its own thread so that a slow stage only holds up
+    // the stages after it. Fitting never waits for rendering: when only
+    // displaying, the renderer just picks up the latest fitted frame.
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+    const bool render{!headless || video_output_file};
+    // Frames that were fresh when captured would still go stale waiting
+    // behind a slow fit, so unless recording, fitting takes the latest one.
+    channel::Channel<app_support::CapturedFrame> frames{
+        video_output_file ? frame_queue_capacity : 1,
+        video_output_file ? channel::OverflowPolicy::block
+                          : channel::OverflowPolicy::drop_oldest};
+    channel::Channel<FittedFrame> fitted_frames{
+        video_output_file ? recording_queue_capacity : 1,
+        video_output_file ? channel::OverflowPolicy::block
+                          : channel::OverflowPolicy::drop_oldest};
+
+    // A recording must contain every frame, but otherwise the video should
+    // behave like a live camera.
+    std::optional<frame_scheduler::FrameScheduler> scheduler{};
+    if (!video_output_file) {
+        scheduler.emplace(latency_budget);
+    }
+    std::thread capture_thread{[&capture, &scheduler, &frames] {
+        app_support::capture_frames(capture,
+                                    scheduler ? &*scheduler : nullptr,
+                                    stop_requested, frames);
+    }};
+    std::thread fit_thread{[&world, &camera_to_drone, &frames, &predictor,
+                            &sender, &fitted_frames, render] {
+        fit_frames(world, camera_to_drone, frames,
+                   predictor ? &*predictor : nullptr,
+                   sender ? &*sender : nullptr,
+                   render ? &fitted_frames : nullptr);
+    }};
+    std::thread stream_thread{};
+    if (predictor) {
+        stream_thread = std::thread{[&predictor, &camera_to_drone,
+                                     min_send_interval, &sender] {
+            app_support::stream_poses(*predictor, camera_to_drone,
+                                      min_send_interval, stop_requested,
+                                      *sender);
+        }};
+    }
 
-        const auto fit_result{world.fit(image)};
-        if (fit_result.camera_to_world && mocap) {
-            const auto estimate{bananas::mavlink::drone_position_estimate(
-                camera_to_drone, *fit_result.camera_to_world)};
-            const auto result{mocap->set_vision_position_estimate(estimate)};
-            if (result != mavsdk::Mocap::Result::Success) {
-                std::cerr << "Failed to send Mocap data: " << result << '\n';
+    // Ogre and HighGUI want to be driven from the main thread. When running
+    // headless without recording, the main thread just waits for the video
+    // to end or for a signal.
+    if (render) {
+        cv::Mat render_image{};
+        while (const auto frame{fitted_frames.pop()}) {
+#ifdef ENABLE_VISUALIZER
+            if (visualizer) {
+                visualizer->update(frame->fit_result);
+                visualizer->refresh();
             }
-        }
-
-        visualizer.update(fit_result);
-        visualizer.refresh();
-
-        image.copyTo(render_image);
-        cv::aruco::drawDetectedMarkers(render_image, fit_result.corners,
-                                       fit_result.ids);
-        if (video_output_file) {
-            output.write(render_image);
-        } else {
-            const std::chrono::nanoseconds target_after_start{
-                1'000'000 *
-                static_cast<std::int64_t>(capture.get(cv::CAP_PROP_POS_MSEC))};
-            std::this_thread::sleep_until(start_time + target_after_start);
-
+#endif // ENABLE_VISUALIZER
+
+            frame->image.copyTo(render_image);
+            cv::aruco::drawDetectedMarkers(render_image,
+                                           frame->fit_result.corners,
+                                           frame->fit_result.ids);
+            if (video_output_file) {
+                output.write(render_image);
+                continue;
+            }
+#ifdef ENABLE_VISUALIZER
             cv::imshow("out", render_image);
             if (handle_keys()) {
                 break;
             }
+#endif // ENABLE_VISUALIZER
         }
+
+        // Wind down the other stages in case the user quit early.
+        stop_requested = true;
+        frames.close();
+        fitted_frames.close();
+    }
+    capture_thread.join();
+    fit_thread.join();
+    stop_requested = true;
+    if (stream_thread.joinable()) {
+        stream_thread.join();
+    }
+
+    if (scheduler) {
+        const auto statistics{scheduler->statistics()};
+        std::cerr << "Dropped " << statistics.dropped + frames.dropped()
+                  << " of " << statistics.dropped + statistics.processed
+                  << " frames to keep up with the video\n";
+    }
+    if (sender) {
+        const auto statistics{sender->statistics()};
+        std::cerr << "Sent " << statistics.sent << " pose estimates, "
+                  << statistics.coalesced << " were superseded before sending "
+                  << "and " << statistics.failed << " failed\n";
     }
 #endif
+
+    if (profile_file && profiling::enabled) {
+        std::ofstream profile_stream{*profile_file};
+        profile_stream << nlohmann::json(world.profile()).dump(4) << '\n';
+        if (!profile_stream) {
+            std::cerr << "Failed to write the latency statistics\n";
+            return EXIT_FAILURE;
+        }
+    }
 }
@@ -0,0 +1,201 @@
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
+#include <opencv2/core/utility.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/board.h>
+#include <bananas_aruco/camera_config.h>
+#include <bananas_aruco/concrete_board.h>
+#include <bananas_aruco/renderer.h>
+#include <bananas_aruco/world.h>
+
+namespace {
+
+namespace affine_rotation = bananas::affine_rotation;
+namespace board = bananas::board;
+namespace camera_config = bananas::camera_config;
+namespace renderer = bananas::renderer;
+namespace world = bananas::world;
+
+const char *const about{
+    "Render synthetic camera images of boards with known poses"};
+const char *const keys{
+    "{@poses  | <none> | JSON file listing the camera and box poses of each "
+    "frame }"
+    "{env     | <none> | JSON file describing the static environment }"
+    "{boards  | <none> | JSON file containing the board descriptions }"
+    "{camera  | <none> | JSON file containing the camera information }"
+    "{o       | frames | Output directory }"
+    "{width   | 1920   | Image width }"
+    "{height  | 1080   | Image height }"
+    "{blur    | 0.5    | Standard deviation of the Gaussian blur in pixels }"
+    "{noise   | 2.0    | Standard deviation of the pixel noise }"};
+
+/// The poses of the camera and the dynamic boards in a single frame.
+struct FramePoses {
+    affine_rotation::AffineRotation camera_to_world{};
+    world::BoardPlacement boards{};
+};
+
+void from_json(const nlohmann::json &j, FramePoses &frame) {
+    j.at("camera_to_world").get_to(frame.camera_to_world);
+    frame.boards = {};
+    const auto boards{j.find("boards")};
+    if (boards != j.end()) {
+        world::from_json(*boards, frame.boards);
+    }
+}
+
+auto frame_file_name(std::size_t frame) -> std::string {
+    std::ostringstream name{};
+    name << "frame_" << std::setw(5) << std::setfill('0') << frame << ".png";
+    return name.str();
+}
+
+} // namespace
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+auto main(int argc, char *argv[]) -> int {
+    cv::CommandLineParser parser{argc, argv, keys};
+    parser.about(about);
+
+    const auto poses_file{parser.get<std::string>(0)};
+    const auto camera_file{parser.get<std::string>("camera")};
+    const auto static_environment_file{parser.get<std::string>("env")};
+    const auto board_file{parser.get<std::string>("boards")};
+    const std::filesystem::path output_directory{parser.get<std::string>("o")};
+    const cv::Size image_size{parser.get<int>("width"),
+                              parser.get<int>("height")};
+    const renderer::RenderParameters parameters{
+        200.0, parser.get<double>("blur"), parser.get<double>("noise")};
+    if (!parser.check()) {
+        parser.printErrors();
+        parser.printMessage();
+        return EXIT_FAILURE;
+    }
+    if (image_size.empty() || parameters.blur_sigma < 0.0 ||
+        parameters.noise_sigma < 0.0) {
+        std::cerr << "Invalid image size or noise settings\n";
+        return EXIT_FAILURE;
+    }
+
+    camera_config::CameraConfiguration camera{};
+    std::vector<board::Board> boards{};
+    world::BoardPlacement static_environment{};
+    std::vector<FramePoses> frames{};
+    try {
+        std::ifstream camera_stream{camera_file};
+        if (!camera_stream) {
+            std::cerr << "Failed to open camera information file\n";
+            return EXIT_FAILURE;
+        }
+        nlohmann::json::parse(camera_stream).get_to(camera);
+
+        std::ifstream board_stream{board_file};
+        if (!board_stream) {
+            std::cerr << "Failed to open board file\n";
+            return EXIT_FAILURE;
+        }
+        for (const auto &concrete_board :
+             nlohmann::json::parse(board_stream)
+                 .get<std::vector<board::ConcreteBoard>>()) {
+            boards.push_back(std::visit(
+                [](const auto &settings) {
+                    return board::make_board(settings);
+                },
+                concrete_board));
+        }
+
+        std::ifstream static_env_stream{static_environment_file};
+        if (!static_env_stream) {
+            std::cerr << "Failed to open static environment file\n";
+            return EXIT_FAILURE;
+        }
+        world::from_json(nlohmann::json::parse(static_env_stream),
+                         static_environment);
+
+        std::ifstream poses_stream{poses_file};
+        if (!poses_stream) {
+            std::cerr << "Failed to open pose file\n";
+            return EXIT_FAILURE;
+        }
+        nlohmann::json::parse(poses_stream).get_to(frames);
+    } catch (const std::exception &e) {
+        std::cerr << "Failed to read the configuration: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    const auto dictionary{
+        cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_100)};
+    const renderer::Renderer renderer{
+        camera_config::camera_matrix(camera),
+        camera_config::distortion_coefficients(camera), image_size, dictionary,
+        parameters};
+
+    std::error_code error{};
+    std::filesystem::create_directories(output_directory, error);
+    if (error) {
+        std::cerr << "Failed to create output directory: " << error.message()
+                  << '\n';
+        return EXIT_FAILURE;
+    }
+
+    auto ground_truth{nlohmann::json::array()};
+    std::vector<renderer::BoardPose> poses{};
+    cv::Mat image{};
+    for (std::size_t i{0}; i < frames.size(); ++i) {
+        const auto &frame{frames[i]};
+        const auto world_to_camera{frame.camera_to_world.inverse()};
+        poses.clear();
+        const std::array<const world::BoardPlacement *, 2> all_placements{
+            &static_environment, &frame.boards};
+        for (const auto *placements : all_placements) {
+            for (const auto &[id, board_to_world] : *placements) {
+                if (id >= boards.size()) {
+                    std::cerr << "Frame " << i << " places unknown board "
+                              << id << '\n';
+                    return EXIT_FAILURE;
+                }
+                poses.push_back(
+                    {&boards[id], world_to_camera * board_to_world});
+            }
+        }
+        renderer.render(poses, image, i);
+
+        const auto file_name{frame_file_name(i)};
+        if (!cv::imwrite((output_directory / file_name).string(), image)) {
+            std::cerr << "Failed to write " << file_name << '\n';
+            return EXIT_FAILURE;
+        }
+        ground_truth.push_back({{"image", file_name},
+                                {"camera_to_world", frame.camera_to_world},
+                                {"boards", frame.boards}});
+    }
+
+    std::ofstream ground_truth_stream{output_directory / "ground_truth.json"};
+    ground_truth_stream << ground_truth.dump(4) << '\n';
+    if (!ground_truth_stream) {
+        std::cerr << "Failed to write the ground truth\n";
+        return EXIT_FAILURE;
+    }
+    std::cerr << "Rendered " << frames.size() << " frames into "
+              << output_directory << '\n';
+    return EXIT_SUCCESS;
+}
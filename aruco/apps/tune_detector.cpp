@@ -0,0 +1,370 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/utility.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/objdetect/aruco_detector.hpp>
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+#include <opencv2/videoio.hpp>
+
+#include <bananas_aruco/app_support/app_support.h>
+#include <bananas_aruco/camera_config.h>
+#include <bananas_aruco/detector_config.h>
+#include <bananas_aruco/pixel_format.h>
+#include <bananas_aruco/world.h>
+
+namespace {
+
+namespace app_support = bananas::app_support;
+namespace camera_config = bananas::camera_config;
+namespace detector_config = bananas::detector_config;
+namespace pixel_format = bananas::pixel_format;
+namespace world = bananas::world;
+
+const char *const about{
+    "Search for detector settings that find the markers in a video quickly"};
+const char *const keys{
+    "{@infile  | <none>        | Input video }"
+    "{env      |               | JSON file describing the static environment }"
+    "{boards   |               | JSON file containing the board descriptions }"
+    "{database |               | Board database compiled by compile_boards, "
+    "used instead of -boards and -env }"
+    "{camera   | <none>        | JSON file containing the camera information }"
+    "{o        | detector.json | Output file for the chosen detector settings }"
+    "{frames   | 300           | Maximum number of video frames to use }"
+    "{recall   | 0.95          | Minimum recall of the chosen settings }"
+    "{threads  | 0             | Number of worker threads, 0 for one per "
+    "core }"};
+
+/// Everything needed for setting up a World, apart from the detector.
+struct Scene {
+    cv::Mat camera_matrix;
+    cv::Mat distortion_coefficients;
+    /// Shared by the Worlds of all the configurations.
+    std::shared_ptr<const world::WorldModel> model;
+};
+
+/// How well a detector configuration did on the video.
+struct Evaluation {
+    /// The mean World::fit() latency per frame in milliseconds.
+    double latency{};
+    /// The fraction of the markers found by any of the configurations that
+    /// this configuration found as well.
+    double recall{};
+    /// The mean reprojection error of all the poses found, in pixels.
+    double reprojection_error{};
+    /// The sorted IDs of the markers found in each frame.
+    std::vector<std::vector<int>> frame_ids;
+};
+
+/// Return the detector configurations to try.
+auto candidates() -> std::vector<detector_config::DetectorConfig> {
+    std::vector<detector_config::DetectorConfig> configs{};
+    for (const int win_size_min : {3, 5}) {
+        for (const int win_size_max : {11, 23, 33}) {
+            for (const int win_size_step : {4, 10}) {
+                for (const double perimeter_rate : {0.01, 0.03, 0.05}) {
+                    for (const int refinement :
+                         {cv::aruco::CORNER_REFINE_NONE,
+                          cv::aruco::CORNER_REFINE_SUBPIX}) {
+                        for (const bool aruco3 : {false, true}) {
+                            auto config{detector_config::preset("default")};
+                            auto &detector{config.detector};
+                            detector.adaptiveThreshWinSizeMin = win_size_min;
+                            detector.adaptiveThreshWinSizeMax = win_size_max;
+                            detector.adaptiveThreshWinSizeStep = win_size_step;
+                            detector.minMarkerPerimeterRate = perimeter_rate;
+                            detector.cornerRefinementMethod = refinement;
+                            detector.useAruco3Detection = aruco3;
+                            configs.push_back(config);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return configs;
+}
+
+auto describe(const detector_config::DetectorConfig &config) -> std::string {
+    const auto &detector{config.detector};
+    return "window " + std::to_string(detector.adaptiveThreshWinSizeMin) +
+           "-" + std::to_string(detector.adaptiveThreshWinSizeMax) + "/" +
+           std::to_string(detector.adaptiveThreshWinSizeStep) +
+           ", perimeter " + std::to_string(detector.minMarkerPerimeterRate) +
+           (detector.cornerRefinementMethod == cv::aruco::CORNER_REFINE_NONE
+                ? ""
+                : ", subpixel") +
+           (detector.useAruco3Detection ? ", ArUco3" : "");
+}
+
+/// Run World::fit() with @p config over all @p frames.
+auto evaluate(const Scene &scene,
+              const detector_config::DetectorConfig &config,
+              const std::vector<cv::Mat> &frames) -> Evaluation {
+    world::World world{scene.model, scene.camera_matrix,
+                       scene.distortion_coefficients, config};
+
+    Evaluation evaluation{};
+    evaluation.frame_ids.reserve(frames.size());
+    world::FitWorkspace workspace{};
+    world::FitResult result{};
+    std::chrono::steady_clock::duration total_latency{};
+    double total_error{0.0};
+    std::size_t pose_count{0};
+    for (const auto &frame : frames) {
+        const auto start{std::chrono::steady_clock::now()};
+        world.fit(frame, pixel_format::PixelFormat::gray, workspace, result);
+        total_latency += std::chrono::steady_clock::now() - start;
+
+        if (result.camera_to_world) {
+            total_error += result.camera_to_world->reprojection_error;
+            ++pose_count;
+        }
+        for (const auto &[id, pose] : result.dynamic_board_placements) {
+            total_error += pose.reprojection_error;
+            ++pose_count;
+        }
+        auto ids{result.ids};
+        std::sort(ids.begin(), ids.end());
+        evaluation.frame_ids.push_back(std::move(ids));
+    }
+
+    evaluation.latency =
+        std::chrono::duration<double, std::milli>{total_latency}.count() /
+        static_cast<double>(frames.size());
+    evaluation.reprojection_error =
+        pose_count == 0 ? std::numeric_limits<double>::infinity()
+                        : total_error / static_cast<double>(pose_count);
+    return evaluation;
+}
+
+/// Fill in the recall of each evaluation, treating the markers found by any
+/// of the configurations as the ground truth.
+void compute_recall(std::vector<Evaluation> &evaluations,
+                    std::size_t frame_count) {
+    std::size_t total_markers{0};
+    std::vector<std::size_t> found(evaluations.size());
+    std::vector<int> all_ids{};
+    std::vector<int> merged{};
+    for (std::size_t frame{0}; frame < frame_count; ++frame) {
+        all_ids.clear();
+        for (const auto &evaluation : evaluations) {
+            const auto &ids{evaluation.frame_ids[frame]};
+            merged.clear();
+            std::set_union(all_ids.cbegin(), all_ids.cend(), ids.cbegin(),
+                           ids.cend(), std::back_inserter(merged));
+            std::swap(all_ids, merged);
+        }
+        total_markers += all_ids.size();
+        for (std::size_t i{0}; i < evaluations.size(); ++i) {
+            found[i] += evaluations[i].frame_ids[frame].size();
+        }
+    }
+
+    for (std::size_t i{0}; i < evaluations.size(); ++i) {
+        evaluations[i].recall =
+            total_markers == 0 ? 1.0
+                               : static_cast<double>(found[i]) /
+                                     static_cast<double>(total_markers);
+    }
+}
+
+/// Return true if @p a is at least as good as @p b in every respect and
+/// better in at least one.
+auto dominates(const Evaluation &a, const Evaluation &b) -> bool {
+    const bool no_worse{a.latency <= b.latency && a.recall >= b.recall &&
+                        a.reprojection_error <= b.reprojection_error};
+    const bool better{a.latency < b.latency || a.recall > b.recall ||
+                      a.reprojection_error < b.reprojection_error};
+    return no_worse && better;
+}
+
+/// Return the indices of the evaluations that no other evaluation dominates,
+/// ordered from the fastest to the slowest.
+auto pareto_front(const std::vector<Evaluation> &evaluations)
+    -> std::vector<std::size_t> {
+    std::vector<std::size_t> front{};
+    for (std::size_t i{0}; i < evaluations.size(); ++i) {
+        const bool dominated{std::any_of(
+            evaluations.cbegin(), evaluations.cend(),
+            [&candidate = evaluations[i]](const Evaluation &other) {
+                return dominates(other, candidate);
+            })};
+        if (!dominated) {
+            front.push_back(i);
+        }
+    }
+    std::sort(front.begin(), front.end(),
+              [&evaluations](std::size_t a, std::size_t b) {
+                  return evaluations[a].latency < evaluations[b].latency;
+              });
+    return front;
+}
+
+/// Choose the fastest configuration on @p front whose recall is at least @p
+/// min_recall, or the one with the best recall if there is no such
+/// configuration.
+auto choose(const std::vector<Evaluation> &evaluations,
+            const std::vector<std::size_t> &front,
+            double min_recall) -> std::size_t {
+    const auto good_enough{
+        std::find_if(front.cbegin(), front.cend(),
+                     [&evaluations, min_recall](std::size_t i) {
+                         return evaluations[i].recall >= min_recall;
+                     })};
+    if (good_enough != front.cend()) {
+        return *good_enough;
+    }
+    return *std::max_element(front.cbegin(), front.cend(),
+                             [&evaluations](std::size_t a, std::size_t b) {
+                                 return evaluations[a].recall <
+                                        evaluations[b].recall;
+                             });
+}
+
+} // namespace
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+auto main(int argc, char *argv[]) -> int {
+    cv::CommandLineParser parser{argc, argv, keys};
+    parser.about(about);
+
+    const auto video_file{parser.get<std::string>(0)};
+    const auto camera_file{parser.get<std::string>("camera")};
+    const auto static_environment_file{parser.get<std::string>("env")};
+    const auto board_file{parser.get<std::string>("boards")};
+    const auto database_file{parser.get<std::string>("database")};
+    const auto output_file{parser.get<std::string>("o")};
+    const auto max_frames{parser.get<int>("frames")};
+    const auto min_recall{parser.get<double>("recall")};
+    auto thread_count{parser.get<unsigned int>("threads")};
+    if (!parser.check()) {
+        parser.printErrors();
+        parser.printMessage();
+        return EXIT_FAILURE;
+    }
+    if (database_file.empty() &&
+        (board_file.empty() || static_environment_file.empty())) {
+        std::cerr << "Give either -database or both -boards and -env\n";
+        return EXIT_FAILURE;
+    }
+    if (thread_count == 0) {
+        thread_count = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    // The model keeps a pointer to the dictionary.
+    const auto dictionary{
+        cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_100)};
+    Scene scene{};
+    try {
+        std::ifstream camera_stream{camera_file};
+        if (!camera_stream) {
+            std::cerr << "Failed to open camera information file\n";
+            return EXIT_FAILURE;
+        }
+        const auto camera{nlohmann::json::parse(camera_stream)
+                              .get<camera_config::CameraConfiguration>()};
+        scene.camera_matrix = camera_config::camera_matrix(camera);
+        scene.distortion_coefficients =
+            camera_config::distortion_coefficients(camera);
+        scene.model = app_support::load_model(
+            dictionary, board_file, static_environment_file, database_file);
+    } catch (const std::exception &e) {
+        std::cerr << "Failed to read the configuration: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    // Decode the video up front so that decoding doesn't skew the latencies.
+    std::vector<cv::Mat> frames{};
+    {
+        cv::VideoCapture capture{video_file};
+        cv::Mat image{};
+        while (static_cast<int>(frames.size()) < max_frames &&
+               capture.read(image)) {
+            cv::Mat grey{};
+            cv::cvtColor(image, grey, cv::COLOR_BGR2GRAY);
+            frames.push_back(std::move(grey));
+        }
+    }
+    if (frames.empty()) {
+        std::cerr << "Failed to read any frames from the video\n";
+        return EXIT_FAILURE;
+    }
+
+    const auto configs{candidates()};
+    std::vector<Evaluation> evaluations(configs.size());
+    std::cerr << "Trying " << configs.size() << " configurations on "
+              << frames.size() << " frames with " << thread_count
+              << " threads\n";
+
+    // NOTE: The configurations compete for the cores and the memory
+    // bandwidth, so the latencies are only comparable with each other.
+    std::atomic<std::size_t> next{0};
+    std::vector<std::thread> workers{};
+    try {
+        for (unsigned int i{0}; i < thread_count; ++i) {
+            workers.emplace_back([&] {
+                // OpenCV's own threads would only fight with ours.
+                cv::setNumThreads(1);
+                for (auto config{next++}; config < configs.size();
+                     config = next++) {
+                    evaluations[config] =
+                        evaluate(scene, configs[config], frames);
+                }
+            });
+        }
+    } catch (const std::exception &e) {
+        // Let the workers that did start finish the job.
+        std::cerr << "Failed to start all worker threads: " << e.what()
+                  << '\n';
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    if (workers.empty()) {
+        return EXIT_FAILURE;
+    }
+
+    compute_recall(evaluations, frames.size());
+    const auto front{pareto_front(evaluations)};
+    const auto chosen{choose(evaluations, front, min_recall)};
+
+    std::cout << "Pareto front:\n"
+              << "latency (ms)  recall  reprojection error (px)  settings\n";
+    for (const auto i : front) {
+        const auto &evaluation{evaluations[i]};
+        std::cout << std::fixed << std::setprecision(2) << std::setw(12)
+                  << evaluation.latency << "  " << std::setprecision(3)
+                  << std::setw(6) << evaluation.recall << "  "
+                  << std::setw(23) << evaluation.reprojection_error << "  "
+                  << describe(configs[i]) << (i == chosen ? " (chosen)" : "")
+                  << '\n';
+    }
+
+    std::ofstream output{output_file};
+    if (!output) {
+        std::cerr << "Failed to open output file\n";
+        return EXIT_FAILURE;
+    }
+    output << nlohmann::json(configs[chosen]).dump(4) << '\n';
+    return EXIT_SUCCESS;
+}
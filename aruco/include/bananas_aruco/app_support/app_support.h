@@ -0,0 +1,79 @@
+#ifndef BANANAS_ARUCO_APP_SUPPORT_H_
+#define BANANAS_ARUCO_APP_SUPPORT_H_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+#include <opencv2/videoio.hpp>
+
+#include <mavsdk/plugins/mocap/mocap.h>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/channel.h>
+#include <bananas_aruco/frame_scheduler.h>
+#include <bananas_aruco/mavlink.h>
+#include <bananas_aruco/pose_predictor.h>
+#include <bananas_aruco/profiling.h>
+#include <bananas_aruco/world.h>
+
+/// Building blocks shared by the positioner applications.
+namespace bananas::app_support {
+
+/// How often to report the age of the sent pose estimates.
+constexpr std::chrono::seconds age_report_interval{1};
+
+/// A camera image and when it was captured.
+struct CapturedFrame {
+    cv::Mat image;
+    frame_scheduler::Clock::time_point capture_time;
+};
+
+/// Split the comma-separated @p list into its items.
+[[nodiscard]] auto split(const std::string &list) -> std::vector<std::string>;
+
+/// Describe how old the pose estimates in @p ages were when they were sent.
+[[nodiscard]] auto describe_ages(const profiling::LatencyHistogram &ages)
+    -> std::string;
+
+/// Load the model of the boards and the static environment from
+/// @p database_file, or from @p board_file and @p static_environment_file if
+/// there is no database. A database is checked against the JSON files only
+/// if both are given. @p dictionary must outlive the model.
+///
+/// @throws std::exception if the files can't be read or are invalid.
+[[nodiscard]] auto load_model(const cv::aruco::Dictionary &dictionary,
+                              const std::string &board_file,
+                              const std::string &static_environment_file,
+                              const std::string &database_file)
+    -> std::shared_ptr<const world::WorldModel>;
+
+/// Read frames from @p capture into @p frames until the video ends or @p stop
+/// is set. If @p scheduler isn't null, it paces the frames to real time and
+/// picks the ones that are still fresh enough to be worth processing.
+void capture_frames(cv::VideoCapture &capture,
+                    frame_scheduler::FrameScheduler *scheduler,
+                    const std::atomic<bool> &stop,
+                    channel::Channel<CapturedFrame> &frames);
+
+/// Post the pose of the drone predicted by @p predictor from the poses of a
+/// camera at @p camera_to_drone to @p sender every @p period until @p stop is
+/// set.
+void stream_poses(const pose_predictor::PosePredictor &predictor,
+                  const affine_rotation::AffineRotation &camera_to_drone,
+                  pose_predictor::Clock::duration period,
+                  const std::atomic<bool> &stop, mavlink::PoseSender &sender);
+
+/// Return a function for a mavlink::PoseSender that sends the estimates
+/// through @p mocap and reports failures on the standard error. @p mocap must
+/// outlive the function.
+[[nodiscard]] auto send_reporting_failures(mavsdk::Mocap &mocap)
+    -> mavlink::PoseSender::Send;
+
+} // namespace bananas::app_support
+
+#endif // BANANAS_ARUCO_APP_SUPPORT_H_
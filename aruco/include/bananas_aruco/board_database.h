@@ -0,0 +1,122 @@
+#ifndef BANANAS_ARUCO_BOARD_DATABASE_H_
+#define BANANAS_ARUCO_BOARD_DATABASE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gsl/span>
+
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/board.h>
+#include <bananas_aruco/world.h>
+
+/// A compiled binary form of the board and static environment files. Loading
+/// one skips parsing JSON and generating the board geometry, which can take
+/// seconds with thousands of boards.
+///
+/// A database file consists of a header, followed by the board table, the
+/// marker IDs, the marker corners and the static placements. The numbers are
+/// stored in the byte order of the machine that compiled the file, which the
+/// header records. The header also holds a checksum of the JSON files the
+/// database was compiled from.
+namespace bananas::board_database {
+
+/// The version of the file format. Files of other versions are rejected.
+constexpr std::uint32_t format_version{1};
+
+constexpr std::uint64_t fnv1a_offset_basis{0xcbf29ce484222325ULL};
+
+using StaticPlacements =
+    std::vector<std::pair<world::BoardId, affine_rotation::AffineRotation>>;
+
+/// Return the 64-bit FNV-1a hash of @p data, continuing from @p hash.
+[[nodiscard]] auto fnv1a(gsl::span<const std::byte> data,
+                         std::uint64_t hash = fnv1a_offset_basis)
+    -> std::uint64_t;
+
+/// Return a checksum of the contents of the files at @p paths, in order.
+///
+/// @throws std::runtime_error if a file can't be read.
+[[nodiscard]] auto source_checksum(gsl::span<const std::string> paths)
+    -> std::uint64_t;
+
+/// Write a database of @p boards to @p output. Board IDs are indices into
+/// @p boards, and @p static_placements tells which boards are static.
+void write(std::ostream &output, gsl::span<const board::Board> boards,
+           gsl::span<const std::pair<world::BoardId,
+                                     affine_rotation::AffineRotation>>
+               static_placements,
+           std::uint64_t source_checksum);
+
+/// A database file mapped into memory.
+class BoardDatabase {
+  public:
+    /// Map the database file at @p path.
+    ///
+    /// @throws std::runtime_error if the file can't be mapped or isn't a
+    /// valid database of format_version.
+    explicit BoardDatabase(const std::string &path);
+    ~BoardDatabase();
+
+    BoardDatabase(const BoardDatabase &) = delete;
+    BoardDatabase(BoardDatabase &&) = delete;
+    auto operator=(const BoardDatabase &) -> BoardDatabase & = delete;
+    auto operator=(BoardDatabase &&) -> BoardDatabase & = delete;
+
+    /// Return the checksum of the JSON files the database was compiled from.
+    [[nodiscard]] auto sourceChecksum() const -> std::uint64_t {
+        return source_checksum_;
+    }
+
+    [[nodiscard]] auto boardCount() const -> std::size_t {
+        return board_count_;
+    }
+
+    /// Return the markers of board @p id.
+    [[nodiscard]] auto board(world::BoardId id) const -> board::Board;
+
+    [[nodiscard]] auto staticPlacements() const -> StaticPlacements;
+
+  private:
+    /// Copy a value of type T from @p offset bytes into the file.
+    template <typename T>
+    [[nodiscard]] auto read(std::size_t offset) const -> T;
+
+    const std::byte *data_{nullptr};
+    std::size_t size_{0};
+    std::uint64_t source_checksum_{0};
+    std::size_t board_count_{0};
+    std::size_t static_count_{0};
+    std::size_t marker_count_{0};
+};
+
+/// Create a world model with all the boards and static placements of
+/// @p database. @p dictionary must outlive the model.
+///
+/// @throws std::invalid_argument if the boards use marker IDs that are not
+/// in the dictionary.
+[[nodiscard]] auto make_model(const cv::aruco::Dictionary &dictionary,
+                              const BoardDatabase &database)
+    -> std::shared_ptr<world::WorldModel>;
+
+/// Map the database file at @p path and create a world model from it with
+/// make_model(). If @p sources isn't empty, the database must have been
+/// compiled from those JSON files, in the same order.
+///
+/// @throws std::runtime_error if the database can't be loaded or is out of
+/// date.
+[[nodiscard]] auto load_model(const cv::aruco::Dictionary &dictionary,
+                              const std::string &path,
+                              gsl::span<const std::string> sources = {})
+    -> std::shared_ptr<world::WorldModel>;
+
+} // namespace bananas::board_database
+
+#endif // BANANAS_ARUCO_BOARD_DATABASE_H_
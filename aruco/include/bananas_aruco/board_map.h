@@ -0,0 +1,195 @@
+#ifndef BANANAS_ARUCO_BOARD_MAP_H_
+#define BANANAS_ARUCO_BOARD_MAP_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <bananas_aruco/marker_index.h>
+
+namespace bananas::world {
+
+/// An associative container from BoardId to @p T. Since board IDs are handed
+/// out densely, the values are stored in a flat array indexed by the ID,
+/// making lookups and iteration cheap. Iteration visits the entries in
+/// increasing ID order.
+template <typename T> class BoardMap {
+  private:
+    template <bool Const> class Iterator {
+      public:
+        using Storage = std::conditional_t<Const,
+                                           const std::vector<std::optional<T>>,
+                                           std::vector<std::optional<T>>>;
+        using Value = std::conditional_t<Const, const T, T>;
+
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = std::pair<BoardId, Value &>;
+        using reference = value_type;
+        using pointer = void;
+
+        Iterator(Storage *entries, std::size_t index)
+            : entries_{entries}, index_{index} {
+            skipEmpty();
+        }
+
+        auto operator*() const -> reference {
+            return {static_cast<BoardId>(index_), *(*entries_)[index_]};
+        }
+
+        auto operator++() -> Iterator & {
+            ++index_;
+            skipEmpty();
+            return *this;
+        }
+
+        auto operator++(int) -> Iterator {
+            auto previous{*this};
+            ++*this;
+            return previous;
+        }
+
+        auto operator==(const Iterator &other) const -> bool {
+            return index_ == other.index_;
+        }
+
+        auto operator!=(const Iterator &other) const -> bool {
+            return index_ != other.index_;
+        }
+
+      private:
+        void skipEmpty() {
+            while (index_ < entries_->size() && !(*entries_)[index_]) {
+                ++index_;
+            }
+        }
+
+        Storage *entries_;
+        std::size_t index_;
+    };
+
+  public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    /// Add @p value for @p id unless there already is a value for it.
+    ///
+    /// @return Whether @p value was added.
+    auto emplace(BoardId id, T value) -> bool {
+        auto &entry{slot(id)};
+        if (entry) {
+            return false;
+        }
+        entry.emplace(std::move(value));
+        occupied_.push_back(id);
+        return true;
+    }
+
+    /// Set the value for @p id to @p value, replacing any previous value.
+    void insert_or_assign(BoardId id, T value) {
+        auto &entry{slot(id)};
+        if (!entry) {
+            occupied_.push_back(id);
+        }
+        entry = std::move(value);
+    }
+
+    /// Remove the value for @p id, if any.
+    void erase(BoardId id) {
+        if (id < entries_.size() && entries_[id]) {
+            entries_[id].reset();
+            auto occupied{std::find(occupied_.begin(), occupied_.end(), id)};
+            *occupied = occupied_.back();
+            occupied_.pop_back();
+        }
+    }
+
+    /// Return the value for @p id, or nullptr if there is none.
+    [[nodiscard]] auto find(BoardId id) -> T * {
+        return contains(id) ? &*entries_[id] : nullptr;
+    }
+
+    /// Return the value for @p id, or nullptr if there is none.
+    [[nodiscard]] auto find(BoardId id) const -> const T * {
+        return contains(id) ? &*entries_[id] : nullptr;
+    }
+
+    /// Return the value for @p id.
+    ///
+    /// @throws std::out_of_range if there is no value for @p id.
+    [[nodiscard]] auto at(BoardId id) -> T & {
+        if (!contains(id)) {
+            throw std::out_of_range{"No value for the board ID"};
+        }
+        return *entries_[id];
+    }
+
+    /// Return the value for @p id.
+    ///
+    /// @throws std::out_of_range if there is no value for @p id.
+    [[nodiscard]] auto at(BoardId id) const -> const T & {
+        if (!contains(id)) {
+            throw std::out_of_range{"No value for the board ID"};
+        }
+        return *entries_[id];
+    }
+
+    [[nodiscard]] auto contains(BoardId id) const -> bool {
+        return id < entries_.size() && entries_[id].has_value();
+    }
+
+    [[nodiscard]] auto size() const -> std::size_t { return occupied_.size(); }
+
+    [[nodiscard]] auto empty() const -> bool { return occupied_.empty(); }
+
+    /// Remove all values while keeping the storage for reuse. Only visits the
+    /// IDs that have a value, however large the largest ID is.
+    void clear() {
+        for (const auto id : occupied_) {
+            entries_[id].reset();
+        }
+        occupied_.clear();
+    }
+
+    /// Make room for the IDs below @p board_count without reallocating.
+    void reserve(std::size_t board_count) {
+        if (entries_.size() < board_count) {
+            entries_.resize(board_count);
+        }
+        occupied_.reserve(board_count);
+    }
+
+    [[nodiscard]] auto begin() -> iterator { return {&entries_, 0}; }
+    [[nodiscard]] auto end() -> iterator {
+        return {&entries_, entries_.size()};
+    }
+    [[nodiscard]] auto begin() const -> const_iterator {
+        return {&entries_, 0};
+    }
+    [[nodiscard]] auto end() const -> const_iterator {
+        return {&entries_, entries_.size()};
+    }
+    [[nodiscard]] auto cbegin() const -> const_iterator { return begin(); }
+    [[nodiscard]] auto cend() const -> const_iterator { return end(); }
+
+  private:
+    auto slot(BoardId id) -> std::optional<T> & {
+        if (entries_.size() <= id) {
+            entries_.resize(std::size_t{id} + 1);
+        }
+        return entries_[id];
+    }
+
+    std::vector<std::optional<T>> entries_{};
+    /// The IDs that have a value, in no particular order.
+    std::vector<BoardId> occupied_{};
+};
+
+} // namespace bananas::world
+
+#endif // BANANAS_ARUCO_BOARD_MAP_H_
@@ -0,0 +1,38 @@
+#ifndef BANANAS_ARUCO_CAMERA_CONFIG_H_
+#define BANANAS_ARUCO_CAMERA_CONFIG_H_
+
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <opencv2/core/mat.hpp>
+
+#include <bananas_aruco/affine_rotation.h>
+
+/// The camera information file shared by the applications.
+namespace bananas::camera_config {
+
+/// The intrinsics of a camera and its placement on the drone.
+struct CameraConfiguration {
+    float focal_length_x{};
+    float focal_length_y{};
+    float optical_center_x{};
+    float optical_center_y{};
+    std::vector<float> distortion_coefficients{};
+    affine_rotation::AffineRotation camera_to_drone{};
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(CameraConfiguration, focal_length_x,
+                                   focal_length_y, optical_center_x,
+                                   optical_center_y, distortion_coefficients,
+                                   camera_to_drone);
+
+/// Return the calibration matrix of @p camera in the format OpenCV expects.
+auto camera_matrix(const CameraConfiguration &camera) -> cv::Mat;
+
+/// Return the distortion coefficients of @p camera in the format OpenCV
+/// expects.
+auto distortion_coefficients(const CameraConfiguration &camera) -> cv::Mat;
+
+} // namespace bananas::camera_config
+
+#endif // BANANAS_ARUCO_CAMERA_CONFIG_H_
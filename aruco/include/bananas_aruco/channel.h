@@ -0,0 +1,107 @@
+#ifndef BANANAS_ARUCO_CHANNEL_H_
+#define BANANAS_ARUCO_CHANNEL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include <gsl/assert>
+
+/// Thread-safe queues for passing data between processing stages.
+namespace bananas::channel {
+
+/// What Channel::push() does when the channel is full.
+enum class OverflowPolicy {
+    /// Block the producer until a consumer has made room.
+    block,
+    /// Discard the oldest queued value to make room for the new one. With a
+    /// capacity of one, consumers always get the latest value.
+    drop_oldest,
+};
+
+/// A bounded FIFO queue connecting producer and consumer threads. A channel
+/// can be closed to signal that no more values will be produced.
+template <typename T> class Channel {
+  public:
+    Channel(std::size_t capacity, OverflowPolicy policy)
+        : capacity_{capacity}, policy_{policy} {
+        Expects(capacity > 0);
+    }
+
+    /// Add @p value to the end of the queue.
+    ///
+    /// @return false if the channel has been closed, in which case @p value
+    /// is discarded.
+    auto push(T value) -> bool {
+        std::unique_lock lock{mutex_};
+        if (policy_ == OverflowPolicy::block) {
+            not_full_.wait(lock, [this] {
+                return closed_ || values_.size() < capacity_;
+            });
+        }
+        if (closed_) {
+            return false;
+        }
+        if (values_.size() == capacity_) {
+            values_.pop_front();
+            ++dropped_;
+        }
+        values_.push_back(std::move(value));
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /// Remove the value at the front of the queue, blocking until one is
+    /// available.
+    ///
+    /// @return The value, or std::nullopt if the channel has been closed and
+    /// all remaining values have been consumed.
+    auto pop() -> std::optional<T> {
+        std::unique_lock lock{mutex_};
+        not_empty_.wait(lock, [this] { return closed_ || !values_.empty(); });
+        if (values_.empty()) {
+            return {};
+        }
+        std::optional<T> value{std::move(values_.front())};
+        values_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+        return value;
+    }
+
+    /// Stop accepting new values and wake up all waiting threads. Values
+    /// already in the queue can still be popped.
+    void close() {
+        {
+            const std::lock_guard lock{mutex_};
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    /// Return the number of values discarded because of
+    /// OverflowPolicy::drop_oldest.
+    [[nodiscard]] auto dropped() const -> std::size_t {
+        const std::lock_guard lock{mutex_};
+        return dropped_;
+    }
+
+  private:
+    std::size_t capacity_;
+    OverflowPolicy policy_;
+    mutable std::mutex mutex_{};
+    std::condition_variable not_empty_{};
+    std::condition_variable not_full_{};
+    std::deque<T> values_{};
+    std::size_t dropped_{0};
+    bool closed_{false};
+};
+
+} // namespace bananas::channel
+
+#endif // BANANAS_ARUCO_CHANNEL_H_
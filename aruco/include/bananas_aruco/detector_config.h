@@ -0,0 +1,41 @@
+#ifndef BANANAS_ARUCO_DETECTOR_CONFIG_H_
+#define BANANAS_ARUCO_DETECTOR_CONFIG_H_
+
+#include <string>
+
+#include <nlohmann/json_fwd.hpp>
+
+#include <opencv2/objdetect/aruco_detector.hpp>
+
+/// Settings for the ArUco marker detector.
+namespace bananas::detector_config {
+
+/// The parameters of cv::aruco::ArucoDetector.
+struct DetectorConfig {
+    cv::aruco::DetectorParameters detector{};
+    cv::aruco::RefineParameters refine{};
+};
+
+/// Return the preset called @p name. The available presets are "default"
+/// (OpenCV's defaults), "fast" and "accurate".
+///
+/// @throws std::invalid_argument if there is no such preset.
+auto preset(const std::string &name) -> DetectorConfig;
+
+/// Parse a detector configuration from either a preset name or an object
+/// like this:
+///
+///     {
+///         "preset": "fast",
+///         "detector": {"adaptive_thresh_win_size_max": 13},
+///         "refine": {"min_rep_distance": 5.0}
+///     }
+///
+/// All of the members are optional. The parameters in "detector" and "refine"
+/// override those of the preset, which defaults to "default".
+void from_json(const nlohmann::json &j, DetectorConfig &config);
+void to_json(nlohmann::json &j, const DetectorConfig &config);
+
+} // namespace bananas::detector_config
+
+#endif // BANANAS_ARUCO_DETECTOR_CONFIG_H_
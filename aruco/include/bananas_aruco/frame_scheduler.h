@@ -0,0 +1,53 @@
+#ifndef BANANAS_ARUCO_FRAME_SCHEDULER_H_
+#define BANANAS_ARUCO_FRAME_SCHEDULER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+
+/// Pacing of recorded video so that it behaves like a live camera.
+namespace bananas::frame_scheduler {
+
+using Clock = std::chrono::steady_clock;
+
+/// How many frames a FrameScheduler has let through and dropped.
+struct FrameStatistics {
+    std::size_t processed{0};
+    std::size_t dropped{0};
+};
+
+/// Decides when to process each frame of a recorded video so that processing
+/// stays in step with real time. Frames are held back until their timestamp
+/// comes up, and frames that are already too late by the time they are
+/// reached are dropped, so that a slow consumer always skips ahead to the
+/// newest frame instead of falling further and further behind.
+///
+/// A scheduler is meant to be used by a single thread.
+class FrameScheduler {
+  public:
+    /// @p latency_budget is how late a frame may be and still be processed.
+    explicit FrameScheduler(Clock::duration latency_budget);
+
+    /// Decide what to do with the frame at @p timestamp from the start of the
+    /// video at time @p now. The first frame starts the playback clock.
+    ///
+    /// @return The time at which to process the frame, or std::nullopt if the
+    /// frame should be dropped.
+    [[nodiscard]] auto schedule(Clock::duration timestamp,
+                                Clock::time_point now)
+        -> std::optional<Clock::time_point>;
+
+    [[nodiscard]] auto statistics() const -> FrameStatistics {
+        return statistics_;
+    }
+
+  private:
+    Clock::duration latency_budget_;
+    /// The time corresponding to the start of the video.
+    std::optional<Clock::time_point> start_{};
+    FrameStatistics statistics_{};
+};
+
+} // namespace bananas::frame_scheduler
+
+#endif // BANANAS_ARUCO_FRAME_SCHEDULER_H_
@@ -0,0 +1,77 @@
+#ifndef BANANAS_ARUCO_FUSION_H_
+#define BANANAS_ARUCO_FUSION_H_
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include <gsl/span>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/world.h>
+
+/// Combining the World::fit() results of several cameras on the drone.
+namespace bananas::fusion {
+
+using Clock = std::chrono::steady_clock;
+
+/// The drone pose and dynamic board placements seen by all cameras at one
+/// time step.
+struct FusedResult {
+    std::optional<world::UncertainPose> drone_to_world;
+    world::UncertainPlacement dynamic_board_placements;
+    /// The capture time of the newest camera frame that went into the result.
+    Clock::time_point capture_time;
+    /// The number of cameras whose results went into the result.
+    std::size_t camera_count{0};
+};
+
+/// Return the weighted average of @p poses. Poses with lower reprojection
+/// errors get more weight. The poses should be close to each other, since
+/// the rotations are averaged component-wise.
+[[nodiscard]] auto average(gsl::span<const world::UncertainPose> poses)
+    -> world::UncertainPose;
+
+/// Fuses the results of cameras that run World::fit() independently of each
+/// other, at their own frame rates. Each new result is fused with the latest
+/// results of the other cameras, as long as they were captured close enough
+/// in time to describe the same moment.
+///
+/// A fuser is meant to be used by a single thread.
+class Fuser {
+  public:
+    /// Fuse the results of cameras placed on the drone at @p camera_to_drone.
+    /// Results captured more than @p max_skew before the newest one are left
+    /// out.
+    Fuser(std::vector<affine_rotation::AffineRotation> camera_to_drone,
+          Clock::duration max_skew);
+
+    /// Replace the latest result of @p camera with @p result and fuse it with
+    /// the latest results of the other cameras into @p fused.
+    void update(std::size_t camera, const world::FitResult &result,
+                FusedResult &fused);
+
+    [[nodiscard]] auto cameraCount() const -> std::size_t {
+        return camera_to_drone_.size();
+    }
+
+  private:
+    /// What the latest result of a camera says about the drone.
+    struct CameraState {
+        Clock::time_point capture_time;
+        std::optional<world::UncertainPose> drone_to_world;
+        world::UncertainPlacement dynamic_board_placements;
+    };
+
+    std::vector<affine_rotation::AffineRotation> camera_to_drone_;
+    Clock::duration max_skew_;
+    std::vector<std::optional<CameraState>> latest_;
+    /// Buffers reused from one update to the next.
+    std::vector<world::UncertainPose> drone_poses_{};
+    world::BoardMap<std::vector<world::UncertainPose>> board_poses_{};
+};
+
+} // namespace bananas::fusion
+
+#endif // BANANAS_ARUCO_FUSION_H_
@@ -0,0 +1,75 @@
+#ifndef BANANAS_ARUCO_MARKER_INDEX_H_
+#define BANANAS_ARUCO_MARKER_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace bananas::world {
+
+/// Identifies a board within a World.
+using BoardId = std::uint32_t;
+
+/// The location of a marker within the boards of a World.
+struct MarkerLocation {
+    BoardId board{};
+    /// The index of the marker within the markers of the board.
+    std::uint32_t marker{};
+};
+
+/// A detected marker matched to a marker of a board.
+struct MarkerMatch {
+    /// The index of the detection in the detected marker list.
+    std::size_t detection{};
+    /// The index of the marker within the markers of the board.
+    std::uint32_t marker{};
+};
+
+/// Detected markers grouped by the boards they belong to.
+struct DetectionBuckets {
+    /// The matched markers of each board, indexed by BoardId.
+    std::vector<std::vector<MarkerMatch>> matches;
+    /// The boards with at least one matched marker, in the order in which
+    /// their first markers were detected.
+    std::vector<BoardId> boards;
+};
+
+/// A lookup table from ArUco marker IDs to the boards containing them. Each
+/// marker ID can belong to at most one board.
+class MarkerIndex {
+  public:
+    /// Create an empty index for the marker IDs of a dictionary containing @p
+    /// dictionary_size markers.
+    explicit MarkerIndex(std::size_t dictionary_size);
+
+    /// Add the markers of a new board to the index. Board IDs must be added in
+    /// order, starting from zero.
+    ///
+    /// @throws std::invalid_argument if a marker ID is outside the dictionary
+    /// or already belongs to a board. The index is left unchanged in this
+    /// case.
+    void addBoard(BoardId board, const std::vector<int> &marker_ids);
+
+    /// Return the location of the marker with the given ID, if any board
+    /// contains it.
+    [[nodiscard]]
+    auto find(int marker_id) const -> std::optional<MarkerLocation>;
+
+    /// Group the detected markers with the given @p ids by board into @p
+    /// buckets. Markers not belonging to any board are ignored. The storage
+    /// of @p buckets is reused between calls.
+    void partition(const std::vector<int> &ids,
+                   DetectionBuckets &buckets) const;
+
+    /// Return the number of boards in the index.
+    [[nodiscard]] auto boardCount() const -> std::size_t;
+
+  private:
+    std::vector<std::optional<MarkerLocation>> locations_;
+    std::size_t board_count_{0};
+};
+
+} // namespace bananas::world
+
+#endif // BANANAS_ARUCO_MARKER_INDEX_H_
@@ -1,17 +1,96 @@
 #ifndef BANANAS_ARUCO_MAVLINK_H_
 #define BANANAS_ARUCO_MAVLINK_H_
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
 #include <mavsdk/plugins/mocap/mocap.h>
 
 #include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/channel.h>
+#include <bananas_aruco/profiling.h>
 #include <bananas_aruco/world.h>
 
 /// Functions helping with MAVLink integration.
 namespace bananas::mavlink {
 
+/// The `time_usec` of a VisionPositionEstimate describing the drone at @p time.
+/// MAVSDK converts it to the autopilot's clock when sending.
+auto timestamp_usec(std::chrono::steady_clock::time_point time)
+    -> std::uint64_t;
+
+/// The estimate of the drone pose at @p time, when the camera was at
+/// @p camera_to_world. Stamping it with the capture time lets PX4 compensate
+/// for the processing delay.
 mavsdk::Mocap::VisionPositionEstimate
 drone_position_estimate(const affine_rotation::AffineRotation &camera_to_drone,
-                        const world::UncertainPose &camera_to_world);
+                        const world::UncertainPose &camera_to_world,
+                        std::chrono::steady_clock::time_point time);
+
+/// Sends pose estimates to the drone on a thread of its own, so that a
+/// stalled MAVLink connection never holds up pose estimation. Only the latest
+/// estimate is kept: an estimate posted while the previous one is still
+/// waiting to be sent replaces it.
+class PoseSender {
+  public:
+    using Send = std::function<mavsdk::Mocap::Result(
+        const mavsdk::Mocap::VisionPositionEstimate &)>;
+
+    struct Statistics {
+        /// The number of estimates sent successfully.
+        std::size_t sent{0};
+        /// The number of estimates replaced by newer ones before sending.
+        std::size_t coalesced{0};
+        /// The number of estimates that @p send failed to send.
+        std::size_t failed{0};
+    };
+
+    /// Send the posted estimates with @p send, at most one every
+    /// @p min_interval.
+    PoseSender(Send send, std::chrono::steady_clock::duration min_interval);
+
+    /// Send the posted estimates through @p mocap, at most one every
+    /// @p min_interval. @p mocap must outlive the sender.
+    PoseSender(mavsdk::Mocap &mocap,
+               std::chrono::steady_clock::duration min_interval);
+
+    PoseSender(const PoseSender &) = delete;
+    PoseSender(PoseSender &&) = delete;
+    auto operator=(const PoseSender &) -> PoseSender & = delete;
+    auto operator=(PoseSender &&) -> PoseSender & = delete;
+
+    /// Send the estimate still waiting, if any, and stop the sender thread.
+    ~PoseSender();
+
+    /// Queue @p estimate for sending, replacing any estimate still waiting.
+    void post(mavsdk::Mocap::VisionPositionEstimate estimate);
+
+    [[nodiscard]] auto statistics() const -> Statistics;
+
+    /// Return how old the estimates sent since the previous call were when
+    /// they were sent, judging by their `time_usec`. Estimates without a
+    /// timestamp are left out.
+    [[nodiscard]] auto takeAges() -> profiling::LatencyHistogram;
+
+  private:
+    void run();
+
+    Send send_;
+    std::chrono::steady_clock::duration min_interval_;
+    channel::Channel<mavsdk::Mocap::VisionPositionEstimate> mailbox_{
+        1, channel::OverflowPolicy::drop_oldest};
+    std::atomic<std::size_t> sent_{0};
+    std::atomic<std::size_t> failed_{0};
+    std::mutex ages_mutex_{};
+    profiling::LatencyHistogram ages_{};
+    // Keep this last so that the other members are ready when it starts.
+    std::thread thread_;
+};
 
 } // namespace bananas::mavlink
 
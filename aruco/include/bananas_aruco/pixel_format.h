@@ -0,0 +1,39 @@
+#ifndef BANANAS_ARUCO_PIXEL_FORMAT_H_
+#define BANANAS_ARUCO_PIXEL_FORMAT_H_
+
+#include <opencv2/core/mat.hpp>
+
+/// Helpers for working with camera images in different pixel formats.
+namespace bananas::pixel_format {
+
+/// The layout of the pixels in an 8-bit camera image.
+///
+/// The YUV 4:2:0 formats are stored the way OpenCV expects them: as a single
+/// channel image with 3/2 times the rows of the picture, starting with the
+/// full resolution Y plane.
+enum class PixelFormat {
+    /// Three channels in blue, green, red order.
+    bgr,
+    /// A single grey or luma channel.
+    gray,
+    /// The Y plane followed by interleaved U and V samples.
+    nv12,
+    /// The Y plane followed by interleaved V and U samples.
+    nv21,
+    /// The Y plane followed by the U plane and the V plane.
+    i420,
+};
+
+/// Return the greyscale version of @p image, which is in @p format. For all
+/// formats except PixelFormat::bgr, the result shares its pixels with @p
+/// image. BGR images are converted into @p buffer.
+[[nodiscard]]
+auto luma(const cv::Mat &image, PixelFormat format, cv::Mat &buffer) -> cv::Mat;
+
+/// Convert @p image, which is in @p format, into a BGR image in @p bgr, e.g.
+/// for drawing on it.
+void to_bgr(const cv::Mat &image, PixelFormat format, cv::Mat &bgr);
+
+} // namespace bananas::pixel_format
+
+#endif // BANANAS_ARUCO_PIXEL_FORMAT_H_
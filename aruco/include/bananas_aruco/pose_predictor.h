@@ -0,0 +1,68 @@
+#ifndef BANANAS_ARUCO_POSE_PREDICTOR_H_
+#define BANANAS_ARUCO_POSE_PREDICTOR_H_
+
+#include <chrono>
+#include <mutex>
+#include <optional>
+
+#include <Eigen/Core>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/world.h>
+
+/// Extrapolation of camera poses between camera frames.
+namespace bananas::pose_predictor {
+
+using Clock = std::chrono::steady_clock;
+
+struct PredictorParameters {
+    /// How far past the latest measurement poses are extrapolated. Later
+    /// predictions are refused, since the camera has most likely lost track.
+    Clock::duration max_horizon{std::chrono::milliseconds{200}};
+    /// Measurements further apart than this don't tell anything about the
+    /// velocity, so the velocity is reset instead.
+    Clock::duration max_gap{std::chrono::milliseconds{500}};
+    /// The weight of the latest measured velocity in the smoothed velocity,
+    /// in (0, 1]. Lower values trade responsiveness for less jitter.
+    float velocity_smoothing{0.5F};
+};
+
+/// Predicts the pose of a camera at any moment from its measured poses by
+/// assuming that it keeps moving at a constant linear and angular velocity.
+///
+/// update() and predict() may be called from different threads.
+class PosePredictor {
+  public:
+    explicit PosePredictor(PredictorParameters parameters = {});
+
+    /// Feed in @p camera_to_world measured at @p time. Measurements older
+    /// than the latest one are ignored.
+    void update(const world::UncertainPose &camera_to_world,
+                Clock::time_point time);
+
+    /// Predict the pose at @p time. Times before the latest measurement give
+    /// the latest measurement.
+    ///
+    /// @return The predicted pose, or std::nullopt if there are no
+    /// measurements yet or the latest one is older than the horizon.
+    [[nodiscard]] auto predict(Clock::time_point time) const
+        -> std::optional<world::UncertainPose>;
+
+    /// Forget all measurements.
+    void reset();
+
+  private:
+    PredictorParameters parameters_;
+    mutable std::mutex mutex_{};
+    std::optional<world::UncertainPose> latest_{};
+    Clock::time_point latest_time_{};
+    /// In meters per second, in world coordinates.
+    Eigen::Vector3f linear_velocity_{Eigen::Vector3f::Zero()};
+    /// Rotation axis scaled by the angle per second, in world coordinates.
+    Eigen::Vector3f angular_velocity_{Eigen::Vector3f::Zero()};
+    bool has_velocity_{false};
+};
+
+} // namespace bananas::pose_predictor
+
+#endif // BANANAS_ARUCO_POSE_PREDICTOR_H_
@@ -0,0 +1,172 @@
+#ifndef BANANAS_ARUCO_PROFILING_H_
+#define BANANAS_ARUCO_PROFILING_H_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json_fwd.hpp>
+
+#ifdef ENABLE_PROFILING
+#include <bananas_aruco/board_map.h>
+#endif // ENABLE_PROFILING
+#include <bananas_aruco/marker_index.h>
+
+/// Latency measurements of World::fit(). The measurements are only collected
+/// if the library is built with the WITH_PROFILING CMake option; otherwise
+/// the timers compile to nothing.
+namespace bananas::profiling {
+
+using Clock = std::chrono::steady_clock;
+
+#ifdef ENABLE_PROFILING
+inline constexpr bool enabled{true};
+#else  // ENABLE_PROFILING
+inline constexpr bool enabled{false};
+#endif // ENABLE_PROFILING
+
+/// A histogram of latencies with logarithmically sized buckets, so that each
+/// recorded value is known to within 1/16 of itself regardless of its
+/// magnitude. The memory use only grows with the largest recorded value.
+class LatencyHistogram {
+  public:
+    void record(Clock::duration latency);
+
+    [[nodiscard]] auto count() const -> std::uint64_t { return count_; }
+
+    [[nodiscard]] auto max() const -> Clock::duration {
+        return Clock::duration{max_};
+    }
+
+    /// Return the latency below which @p fraction of the recorded latencies
+    /// fall, rounded up to the end of its bucket. Returns zero if nothing has
+    /// been recorded.
+    [[nodiscard]] auto percentile(double fraction) const -> Clock::duration;
+
+  private:
+    static constexpr int sub_bucket_bits{4};
+    static constexpr std::uint64_t sub_bucket_count{1U << sub_bucket_bits};
+
+    [[nodiscard]] static auto bucketIndex(std::uint64_t value) -> std::size_t;
+    /// Return the largest value that falls into bucket @p index.
+    [[nodiscard]] static auto bucketEnd(std::size_t index) -> std::uint64_t;
+
+    std::vector<std::uint64_t> buckets_{};
+    std::uint64_t count_{0};
+    std::uint64_t max_{0};
+};
+
+/// Write the sample count and the 50th and 99th percentile and maximum
+/// latencies in milliseconds.
+void to_json(nlohmann::json &j, const LatencyHistogram &histogram);
+
+/// The stages of World::fit().
+enum class Stage : std::uint8_t {
+    /// Marker detection, either on the whole image or on the tracked regions.
+    detect,
+    /// Refining corners found at a lower pyramid level.
+    refine_corners,
+    /// Recovering undetected markers of the static environment.
+    refine_static,
+    /// Grouping the detected markers by board.
+    match,
+    /// Recovering undetected markers of the dynamic boards.
+    refine_dynamic,
+    /// Removing the lens distortion from the detected corners.
+    undistort,
+    /// Solving the camera pose from the static environment.
+    solve_static,
+    /// Solving the poses of all the dynamic boards.
+    solve_dynamic,
+    /// The whole of World::fit().
+    total,
+};
+
+inline constexpr std::size_t stage_count{
+    static_cast<std::size_t>(Stage::total) + 1};
+
+/// Return the snake_case name of @p stage.
+auto name(Stage stage) -> std::string_view;
+
+#ifdef ENABLE_PROFILING
+
+/// Records the time from its construction to its destruction.
+class ScopedTimer {
+  public:
+    explicit ScopedTimer(LatencyHistogram &histogram)
+        : histogram_{&histogram}, start_{Clock::now()} {}
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer(ScopedTimer &&) = delete;
+    auto operator=(const ScopedTimer &) -> ScopedTimer & = delete;
+    auto operator=(ScopedTimer &&) -> ScopedTimer & = delete;
+
+    ~ScopedTimer() { histogram_->record(Clock::now() - start_); }
+
+  private:
+    LatencyHistogram *histogram_;
+    Clock::time_point start_;
+};
+
+/// The latencies of World::fit() per stage and per dynamic board.
+class FitProfile {
+  public:
+    [[nodiscard]] auto time(Stage stage) -> ScopedTimer {
+        return ScopedTimer{stages_[static_cast<std::size_t>(stage)]};
+    }
+
+    /// Time solving the pose of the dynamic board @p board_id.
+    [[nodiscard]] auto timeBoard(world::BoardId board_id) -> ScopedTimer;
+
+    [[nodiscard]] auto stage(Stage stage) const -> const LatencyHistogram & {
+        return stages_[static_cast<std::size_t>(stage)];
+    }
+
+    /// The pose solving latencies of each dynamic board that has been seen.
+    [[nodiscard]] auto boards() const
+        -> const world::BoardMap<LatencyHistogram> & {
+        return boards_;
+    }
+
+  private:
+    std::array<LatencyHistogram, stage_count> stages_{};
+    world::BoardMap<LatencyHistogram> boards_{};
+};
+
+#else // ENABLE_PROFILING
+
+/// Does nothing since profiling is disabled.
+class ScopedTimer {
+  public:
+    ScopedTimer() = default;
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer(ScopedTimer &&) = delete;
+    auto operator=(const ScopedTimer &) -> ScopedTimer & = delete;
+    auto operator=(ScopedTimer &&) -> ScopedTimer & = delete;
+    // Keep the compiler from warning about unused timers.
+    // NOLINTNEXTLINE(modernize-use-equals-default)
+    ~ScopedTimer() {}
+};
+
+/// Records nothing since profiling is disabled.
+class FitProfile {
+  public:
+    [[nodiscard]] auto time(Stage /*stage*/) -> ScopedTimer { return {}; }
+
+    [[nodiscard]] auto timeBoard(world::BoardId /*board_id*/) -> ScopedTimer {
+        return {};
+    }
+};
+
+#endif // ENABLE_PROFILING
+
+/// Write the latencies of each stage and each board, or an empty object if
+/// profiling is disabled.
+void to_json(nlohmann::json &j, const FitProfile &profile);
+
+} // namespace bananas::profiling
+
+#endif // BANANAS_ARUCO_PROFILING_H_
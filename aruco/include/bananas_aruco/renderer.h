@@ -0,0 +1,79 @@
+#ifndef BANANAS_ARUCO_RENDERER_H_
+#define BANANAS_ARUCO_RENDERER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <gsl/pointers>
+#include <gsl/span>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/board.h>
+
+/// Rendering of synthetic camera images of boards with known poses.
+namespace bananas::renderer {
+
+/// Settings for making the rendered images look more like camera images.
+struct RenderParameters {
+    /// The grey level of the background.
+    double background{200.0};
+    /// The standard deviation of the Gaussian blur applied to the image in
+    /// pixels, or zero for no blur.
+    double blur_sigma{0.0};
+    /// The standard deviation of the Gaussian noise added to each pixel, or
+    /// zero for no noise.
+    double noise_sigma{0.0};
+};
+
+/// A board together with its pose relative to the camera in the glTF camera
+/// coordinate system: +X is left, +Y is up and the camera looks towards +Z.
+struct BoardPose {
+    gsl::not_null<const board::Board *> board;
+    affine_rotation::AffineRotation board_to_camera;
+};
+
+/// Renders greyscale images of boards as seen by a camera with the given
+/// intrinsics, drawing the markers of each board where the camera would see
+/// them. The result only depends on the inputs, so the images can be used as
+/// repeatable test and benchmark inputs.
+class Renderer {
+  public:
+    Renderer(cv::Mat camera_matrix, cv::Mat distortion_coeffs,
+             cv::Size image_size, const cv::aruco::Dictionary &dictionary,
+             const RenderParameters &parameters = {});
+
+    /// Render @p boards into @p image. Markers facing away from the camera or
+    /// partially behind it are skipped. @p seed seeds the noise.
+    void render(gsl::span<const BoardPose> boards, cv::Mat &image,
+                std::uint64_t seed = 0) const;
+
+    /// Project @p points given in the glTF camera coordinate system onto the
+    /// image, ignoring the lens distortion.
+    [[nodiscard]] auto
+    project(const std::vector<cv::Point3f> &points) const
+        -> std::vector<cv::Point2f>;
+
+    [[nodiscard]] auto imageSize() const -> cv::Size { return image_size_; }
+
+  private:
+    /// Draw marker @p id onto the undistorted @p image so that its corners
+    /// land on @p corners, given in the glTF camera coordinate system.
+    void drawMarker(cv::Mat &image, int id,
+                    const std::vector<cv::Point3f> &corners) const;
+
+    cv::Mat camera_matrix_;
+    cv::Size image_size_;
+    gsl::not_null<const cv::aruco::Dictionary *> dictionary_;
+    RenderParameters parameters_;
+    /// For each pixel of the distorted image, the location to sample in the
+    /// undistorted image. Empty if the camera has no lens distortion.
+    cv::Mat distortion_map_{};
+};
+
+} // namespace bananas::renderer
+
+#endif // BANANAS_ARUCO_RENDERER_H_
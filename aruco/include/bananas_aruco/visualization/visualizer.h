@@ -1,9 +1,6 @@
 #ifndef BANANAS_ARUCO_VISUALIZER_H_
 #define BANANAS_ARUCO_VISUALIZER_H_
 
-#include <unordered_map>
-#include <unordered_set>
-
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 
@@ -18,6 +15,7 @@
 #include <OgreSceneNode.h>
 
 #include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/board_map.h>
 #include <bananas_aruco/box_board.h>
 #include <bananas_aruco/grid_board.h>
 #include <bananas_aruco/world.h>
@@ -64,6 +62,8 @@ class Visualizer {
     struct ColoredObject {
         gsl::not_null<Ogre::SceneNode *> node;
         Ogre::MaterialPtr material;
+        /// Whether the object stays visible even if it's not found.
+        bool forced_visible;
     };
 
     InitializedContext context_{};
@@ -74,8 +74,7 @@ class Visualizer {
     KeyHandler key_handler_;
     gsl::not_null<Ogre::SceneNode *> static_environment_;
     ColoredObject camera_visualization_;
-    std::unordered_map<world::BoardId, ColoredObject> objects_{};
-    std::unordered_set<world::BoardId> forced_visible_{};
+    world::BoardMap<ColoredObject> objects_{};
 };
 
 } // namespace bananas::visualizer
@@ -1,16 +1,20 @@
 #ifndef BANANAS_ARUCO_WORLD_H_
 #define BANANAS_ARUCO_WORLD_H_
 
-#include <cstdint>
+#include <chrono>
+#include <cstddef>
+#include <memory>
 #include <optional>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <gsl/pointers>
+#include <gsl/span>
 
 #include <nlohmann/json_fwd.hpp>
 
 #include <opencv2/core/mat.hpp>
+#include <opencv2/core/matx.hpp>
 #include <opencv2/core/types.hpp>
 #include <opencv2/objdetect/aruco_board.hpp>
 #include <opencv2/objdetect/aruco_detector.hpp>
@@ -18,75 +22,385 @@
 
 #include <bananas_aruco/affine_rotation.h>
 #include <bananas_aruco/board.h>
+#include <bananas_aruco/board_map.h>
+#include <bananas_aruco/detector_config.h>
+#include <bananas_aruco/marker_index.h>
+#include <bananas_aruco/pixel_format.h>
+#include <bananas_aruco/profiling.h>
 
 /// Structures and functions related to the world model.
 namespace bananas::world {
 
-using BoardId = std::uint32_t;
-using BoardPlacement =
-    std::unordered_map<BoardId, affine_rotation::AffineRotation>;
+using BoardPlacement = BoardMap<affine_rotation::AffineRotation>;
 
+/// No model has this many boards: every board needs markers of its own, and
+/// the ArUco dictionaries are far smaller.
+inline constexpr std::size_t max_board_count{std::size_t{1} << 16U};
+
+/// @throws std::invalid_argument if a board ID is not below max_board_count.
 void from_json(const nlohmann::json &j, BoardPlacement &placement);
+void to_json(nlohmann::json &j, const BoardPlacement &placement);
 
 struct UncertainPose {
     float reprojection_error{};
     affine_rotation::AffineRotation placement{};
 };
 
-using UncertainPlacement = std::unordered_map<BoardId, UncertainPose>;
+using UncertainPlacement = BoardMap<UncertainPose>;
+
+/// Write @p placement as an array of objects with the "id", "board_to_world"
+/// and "reprojection_error" of each board.
+void to_json(nlohmann::json &j, const UncertainPlacement &placement);
 
 struct FitResult {
     std::vector<std::vector<cv::Point2f>> corners;
     std::vector<int> ids;
     std::optional<UncertainPose> camera_to_world;
     UncertainPlacement dynamic_board_placements;
+    /// When the camera captured the frame, or when fit() was called if the
+    /// caller didn't know.
+    std::chrono::steady_clock::time_point capture_time;
 };
 
-/// Our model of the world around us. This model consists of two main parts:
+/// Buffers that World::fit() reuses from one frame to the next instead of
+/// allocating them anew. A workspace can be used with any World, but only by
+/// one thread at a time.
+struct FitWorkspace {
+    std::vector<std::vector<cv::Point2f>> rejected;
+    std::vector<std::vector<cv::Point2f>> region_corners;
+    std::vector<std::vector<cv::Point2f>> region_rejected;
+    std::vector<int> region_ids;
+    std::vector<std::vector<cv::Point2f>> nearby_candidates;
+    /// Point buffers of earlier frames' markers and candidates, reused for
+    /// copying this frame's ones.
+    std::vector<std::vector<cv::Point2f>> spare_points;
+    std::vector<cv::Rect> regions;
+    cv::Mat downscaled;
+    /// The greyscale version of a colour frame.
+    cv::Mat grey;
+    std::vector<cv::Point2f> corner_points;
+    /// The detected marker corners with the lens distortion removed, four per
+    /// marker.
+    std::vector<cv::Point2f> undistorted_corners;
+    DetectionBuckets buckets;
+    std::vector<cv::Point3f> object_points;
+    std::vector<cv::Point2f> image_points;
+    std::vector<cv::Vec3f> rvecs;
+    std::vector<cv::Vec3f> tvecs;
+    std::vector<float> reprojection_errors;
+};
+
+/// Settings for searching markers only near the locations predicted from the
+/// previous frame.
+struct TrackingParameters {
+    /// Scan the whole image at least once every this many frames, so that
+    /// boards entering the view get noticed.
+    int full_scan_period{30};
+    /// How much to grow the predicted marker regions on each side, relative to
+    /// the larger side of the projected marker.
+    float relative_padding{0.5F};
+    /// The minimum amount to grow the predicted marker regions on each side,
+    /// in pixels.
+    int min_padding{16};
+    /// Scan the whole image instead if the predicted regions cover more than
+    /// this fraction of it.
+    float max_coverage{0.5F};
+};
+
+/// Settings for detecting markers on a downscaled copy of the image.
+struct PyramidParameters {
+    /// Halve the image resolution for detection as long as the smallest marker
+    /// found in the previous frame stays at least this many pixels wide.
+    float min_marker_side{32.0F};
+    /// The maximum number of times to halve the image resolution.
+    int max_level{3};
+};
+
+/// The boards of the world and the static environment, i.e., the boards whose
+/// exact locations we know. Once set up, a model can be shared by any number
+/// of World instances, also ones fitting on different threads, since fitting
+/// only reads the model.
+class WorldModel {
+  public:
+    /// @p dictionary must outlive the model.
+    explicit WorldModel(const cv::aruco::Dictionary &dictionary);
+
+    /// Add the given board to the world.
+    ///
+    /// @return The identifier of the added board.
+    /// @throws std::invalid_argument if the board uses marker IDs that are not
+    /// in the dictionary or that are already used by another board.
+    auto addBoard(const board::Board &board) -> BoardId;
+
+    /// Move the given board into the static environment, locking its position
+    /// and orientation. Boards that are already static are left in place.
+    ///
+    /// @throws std::invalid_argument if there is no board with ID @p id.
+    void makeStatic(BoardId id,
+                    const affine_rotation::AffineRotation &board_to_world);
+
+    /// Move all of the given boards into the static environment at once.
+    /// This is much faster than moving them one at a time.
+    ///
+    /// @throws std::invalid_argument if one of the IDs is not below
+    /// boardCount(). No board is moved then.
+    void makeStatic(
+        gsl::span<const std::pair<BoardId, affine_rotation::AffineRotation>>
+            placements);
+
+    [[nodiscard]] auto dictionary() const -> const cv::aruco::Dictionary & {
+        return *dictionary_;
+    }
+
+    [[nodiscard]] auto boardCount() const -> std::size_t {
+        return all_boards_.size();
+    }
+
+    [[nodiscard]] auto board(BoardId id) const -> const cv::aruco::Board & {
+        return all_boards_[id];
+    }
+
+    /// Return the markers of all static boards in world coordinates.
+    [[nodiscard]] auto staticEnvironment() const -> const cv::aruco::Board & {
+        return static_environment_;
+    }
+
+    /// Return the index of the first marker of board @p id in
+    /// staticEnvironment(), or std::nullopt if the board is not static.
+    [[nodiscard]] auto staticMarkerOffset(BoardId id) const
+        -> const std::optional<std::size_t> & {
+        return static_marker_offsets_[id];
+    }
+
+    /// Return the size of board @p id relative to its smallest marker.
+    [[nodiscard]] auto boardExtent(BoardId id) const -> float {
+        return board_extents_[id];
+    }
+
+    [[nodiscard]] auto markerIndex() const -> const MarkerIndex & {
+        return marker_index_;
+    }
+
+  private:
+    /// Add the markers of board @p id to the static marker lists, placed at
+    /// @p board_to_world. This doesn't update static_environment_.
+    void
+    appendStaticBoard(BoardId id,
+                      const affine_rotation::AffineRotation &board_to_world);
+
+    gsl::not_null<const cv::aruco::Dictionary *> dictionary_;
+    cv::aruco::Board static_environment_;
+    /// The markers of static_environment_ in world coordinates.
+    std::vector<std::vector<cv::Point3f>> static_obj_points_{};
+    std::vector<int> static_ids_{};
+    BoardPlacement static_board_placements_{};
+    std::vector<cv::aruco::Board> all_boards_{};
+    MarkerIndex marker_index_;
+    /// For static boards, the index of their first marker in
+    /// static_environment_, indexed by BoardId.
+    std::vector<std::optional<std::size_t>> static_marker_offsets_{};
+    /// The size of each board relative to its smallest marker, indexed by
+    /// BoardId.
+    std::vector<float> board_extents_{};
+};
+
+/// Our model of the world around us as seen through one camera. The model
+/// consists of two main parts:
 ///
 /// 1. The static environment, i.e., all boards whose exact locations we know.
 ///    This is used for finding where the camera is relative to the world.
 /// 2. The dynamic environment, i.e., boxes. The locations and orientations of
 ///    these boxes are recomputed every time World::fit() is called.
+///
+/// The boards live in a WorldModel, while the World itself only keeps the
+/// camera, the detector and what it tracks from one frame to the next. Many
+/// Worlds can share one model to process several video streams at once.
 class World {
   public:
-    // TODO(vainiovano): configurable detector parameters
+    /// Create a World with a model of its own, which addBoard() and
+    /// makeStatic() extend.
     World(cv::Mat camera_matrix, cv::Mat distortion_coeffs,
-          const cv::aruco::Dictionary &dictionary);
+          const cv::aruco::Dictionary &dictionary,
+          const detector_config::DetectorConfig &config = {});
 
-    /// Add the given board to the world.
+    /// Create a World that shares @p model with others. The model must not
+    /// be changed while any World is fitting with it.
+    World(gsl::not_null<std::shared_ptr<const WorldModel>> model,
+          cv::Mat camera_matrix, cv::Mat distortion_coeffs,
+          const detector_config::DetectorConfig &config = {});
+
+    /// Add the given board to the model of this World, which must be its own.
     ///
     /// @return The identifier of the added board.
+    /// @throws std::invalid_argument if the board uses marker IDs that are not
+    /// in the dictionary or that are already used by another board.
     auto addBoard(const board::Board &board) -> BoardId;
 
     /// Move the given board into the static environment, locking its position
-    /// and orientation.
+    /// and orientation. Boards that are already static are left in place. The
+    /// model of this World must be its own.
+    ///
+    /// @throws std::invalid_argument if there is no board with ID @p id.
     void makeStatic(BoardId id,
                     const affine_rotation::AffineRotation &board_to_world);
 
-    /// Find the camera and box locations based on the given camera image.
+    /// Move all of the given boards into the static environment at once.
+    /// This is much faster than moving them one at a time. The model of this
+    /// World must be its own.
+    ///
+    /// @throws std::invalid_argument if one of the IDs is not the ID of a
+    /// board. No board is moved then.
+    void makeStatic(
+        gsl::span<const std::pair<BoardId, affine_rotation::AffineRotation>>
+            placements);
+
+    /// Only search for markers near where the tracked boards were found in
+    /// the previous frame. The whole image is still scanned when a tracked
+    /// board gets lost and periodically as specified by @p parameters.
+    void enableTracking(const TrackingParameters &parameters);
+
+    /// Detect markers on a downscaled image when the markers seen in the
+    /// previous frame were large enough, and refine their corners back at full
+    /// resolution.
+    void enablePyramid(const PyramidParameters &parameters);
+
+    /// Find the camera and box locations based on the given BGR or greyscale
+    /// camera image.
     [[nodiscard]]
-    auto fit(const cv::Mat &image) const -> FitResult;
+    auto fit(const cv::Mat &image) -> FitResult;
+
+    /// Find the camera and box locations based on the given BGR or greyscale
+    /// camera image, overwriting @p result. Reusing the same @p workspace and
+    /// @p result for every frame avoids most memory allocations.
+    void fit(const cv::Mat &image, FitWorkspace &workspace, FitResult &result);
+
+    /// Find the camera and box locations based on the given camera @p frame
+    /// in @p format. Markers are detected on the luma channel, so greyscale
+    /// and YUV frames are used without any colour conversion.
+    void fit(const cv::Mat &frame, pixel_format::PixelFormat format,
+             FitWorkspace &workspace, FitResult &result);
+
+    /// Like the previous overload, but for a @p frame captured at
+    /// @p capture_time, which is passed on in @p result.
+    void fit(const cv::Mat &frame, pixel_format::PixelFormat format,
+             std::chrono::steady_clock::time_point capture_time,
+             FitWorkspace &workspace, FitResult &result);
+
+    /// Return the latencies of the stages of fit() so far. They are only
+    /// recorded if profiling::enabled is set. Don't call this while fit() is
+    /// running.
+    [[nodiscard]] auto profile() const -> const profiling::FitProfile & {
+        return profile_;
+    }
 
   private:
+    /// A board pose relative to the camera in OpenCV conventions.
+    struct PnpSolution {
+        float reprojection_error{};
+        cv::Vec3f rvec{};
+        cv::Vec3f tvec{};
+    };
+
+    /// Try to recover undetected markers of the partially detected dynamic
+    /// boards in the workspace buckets from the rejected candidates. Only
+    /// candidates near the detected markers of each board are considered.
+    ///
+    /// @return Whether any markers were recovered.
+    auto refineDynamicBoards(const cv::Mat &image, FitWorkspace &workspace,
+                             std::vector<std::vector<cv::Point2f>> &corners,
+                             std::vector<int> &ids) const -> bool;
+
+    /// Return the image region that the board @p board_id can cover given its
+    /// detected markers @p matches.
     [[nodiscard]]
-    auto fitBoard(const std::vector<std::vector<cv::Point2f>> &corners,
-                  const std::vector<int> &ids, const cv::aruco::Board &board)
-        const -> std::optional<UncertainPose>;
+    auto searchRegion(BoardId board_id, const std::vector<MarkerMatch> &matches,
+                      const std::vector<std::vector<cv::Point2f>> &corners)
+        const -> cv::Rect2f;
 
-    void recomputeStaticEnvironment();
+    /// Find the pose of a rigid set of markers from matching @p object_points
+    /// and undistorted @p image_points, four per marker. The solver starts
+    /// from the @p previous pose of the markers if there is one, unless that
+    /// leads to a poor fit.
+    [[nodiscard]]
+    auto solvePose(const std::vector<cv::Point3f> &object_points,
+                   const std::vector<cv::Point2f> &image_points,
+                   const std::optional<PnpSolution> &previous,
+                   FitWorkspace &workspace) const
+        -> std::optional<PnpSolution>;
+
+    /// Find the image regions in which the markers of the tracked boards are
+    /// expected to be found, storing them in the workspace regions.
+    void predictRegions(cv::Size image_size, FitWorkspace &workspace) const;
+
+    /// Append the padded image regions of the markers of @p board to the
+    /// workspace regions, assuming that the board is located at @p
+    /// board_to_camera.
+    void predictBoardRegions(const cv::aruco::Board &board,
+                             const PnpSolution &board_to_camera,
+                             cv::Size image_size,
+                             FitWorkspace &workspace) const;
+
+    /// Detect markers only inside @p region of @p image at the current pyramid
+    /// level, appending the results in full image coordinates.
+    void detectInRegion(const cv::Mat &image, cv::Rect region,
+                        FitWorkspace &workspace,
+                        std::vector<std::vector<cv::Point2f>> &corners,
+                        std::vector<int> &ids) const;
+
+    /// Refine @p corners detected at a lower pyramid level on the full
+    /// resolution greyscale @p image.
+    void refineCorners(const cv::Mat &image, FitWorkspace &workspace,
+                       std::vector<std::vector<cv::Point2f>> &corners) const;
+
+    /// Remove the lens distortion from the detected @p corners so that the
+    /// pose solver can use the plain pinhole camera model instead of
+    /// undistorting the same corners on each of its iterations.
+    ///
+    /// @return The undistorted corners in pixel coordinates, four per marker.
+    [[nodiscard]]
+    auto undistortCorners(const std::vector<std::vector<cv::Point2f>> &corners,
+                          FitWorkspace &workspace) const
+        -> const std::vector<cv::Point2f> &;
+
+    /// Choose the pyramid level for the next frame based on the markers found
+    /// in this one.
+    void updatePyramidLevel(
+        const std::vector<std::vector<cv::Point2f>> &corners);
 
     // The reprojection error would be pretty misleading for a single marker
     // since the solver can just find a placement that just happens to fit.
     static constexpr int min_marker_count{2};
+    // A warm-started pose with a larger reprojection error (in pixels) than
+    // this has likely converged to the wrong minimum.
+    static constexpr float max_warm_start_error{2.0F};
 
     cv::Mat camera_matrix_;
     cv::Mat distortion_coeffs_;
-    gsl::not_null<const cv::aruco::Dictionary *> dictionary_;
+    /// The model if this World created it, and null if it is shared.
+    std::shared_ptr<WorldModel> own_model_;
+    std::shared_ptr<const WorldModel> model_;
     cv::aruco::ArucoDetector detector_;
-    cv::aruco::Board static_environment_;
-    BoardPlacement static_board_placements_{};
-    std::vector<cv::aruco::Board> all_boards_{};
+    /// Whether distortion_coeffs_ has any non-zero coefficients.
+    bool has_distortion_;
+
+    /// The world-to-camera pose found in the previous frame. Seeds the pose
+    /// solver and the predicted regions.
+    std::optional<PnpSolution> static_environment_track_{};
+    /// The board-to-camera poses found in the previous frame, indexed by
+    /// BoardId. Grown to the board count of the model when fitting.
+    std::vector<std::optional<PnpSolution>> board_tracks_{};
+    /// The IDs of the boards that have a track, so that fitting only visits
+    /// the boards in view rather than every board of the model.
+    std::vector<BoardId> tracked_boards_{};
+
+    std::optional<TrackingParameters> tracking_{};
+    int frames_since_full_scan_{0};
+    bool track_lost_{false};
+
+    std::optional<PyramidParameters> pyramid_{};
+    int pyramid_level_{0};
+
+    profiling::FitProfile profile_{};
 };
 
 } // namespace bananas::world
@@ -3,6 +3,9 @@
 #include <array>
 #include <utility>
 
+#include <gsl/assert>
+#include <gsl/span>
+
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 
@@ -14,6 +17,14 @@
 
 namespace bananas::affine_rotation {
 
+namespace {
+
+// Spans of points are viewed as 3xN matrices, one point per column.
+static_assert(sizeof(cv::Point3f) == 3 * sizeof(float));
+using PointMatrix = Eigen::Matrix<float, 3, Eigen::Dynamic>;
+
+} // namespace
+
 AffineRotation::AffineRotation()
     : rotation_{1.0F, 0.0F, 0.0F, 0.0F}, translation_{0.0F, 0.0F, 0.0F} {};
 AffineRotation::AffineRotation(Eigen::Quaternionf rotation,
@@ -33,6 +44,26 @@ auto AffineRotation::operator*(cv::Point3f point) const -> cv::Point3f {
     return {result.x(), result.y(), result.z()};
 }
 
+void AffineRotation::transform(gsl::span<const cv::Point3f> points,
+                               gsl::span<cv::Point3f> transformed) const {
+    Expects(points.size() == transformed.size());
+    if (points.empty()) {
+        return;
+    }
+
+    const auto size{static_cast<Eigen::Index>(points.size())};
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    const Eigen::Map<const PointMatrix> in{
+        reinterpret_cast<const float *>(points.data()), 3, size};
+    Eigen::Map<PointMatrix> out{reinterpret_cast<float *>(transformed.data()),
+                                3, size};
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+    const Eigen::Matrix3f rotation{rotation_.toRotationMatrix()};
+    // A lazy product is evaluated coefficient by coefficient straight into
+    // the output, without a temporary matrix.
+    out = rotation.lazyProduct(in).colwise() + translation_;
+}
+
 auto AffineRotation::inverse() const -> AffineRotation {
     const auto rotation_inverse{rotation_.inverse()};
     return {rotation_inverse, -(rotation_inverse * translation_)};
@@ -0,0 +1,167 @@
+#include <bananas_aruco/app_support/app_support.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+#include <opencv2/videoio.hpp>
+
+#include <mavsdk/plugins/mocap/mocap.h>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/board.h>
+#include <bananas_aruco/board_database.h>
+#include <bananas_aruco/channel.h>
+#include <bananas_aruco/concrete_board.h>
+#include <bananas_aruco/frame_scheduler.h>
+#include <bananas_aruco/mavlink.h>
+#include <bananas_aruco/pose_predictor.h>
+#include <bananas_aruco/profiling.h>
+#include <bananas_aruco/world.h>
+
+namespace bananas::app_support {
+
+auto split(const std::string &list) -> std::vector<std::string> {
+    std::vector<std::string> items{};
+    std::istringstream stream{list};
+    std::string item{};
+    while (std::getline(stream, item, ',')) {
+        items.push_back(item);
+    }
+    return items;
+}
+
+auto describe_ages(const profiling::LatencyHistogram &ages) -> std::string {
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    std::ostringstream description{};
+    description.precision(1);
+    description << std::fixed << "Sent " << ages.count()
+                << " pose estimates aged p50 "
+                << Milliseconds{ages.percentile(0.5)}.count() << " ms, p99 "
+                << Milliseconds{ages.percentile(0.99)}.count() << " ms, max "
+                << Milliseconds{ages.max()}.count() << " ms";
+    return description.str();
+}
+
+auto load_model(const cv::aruco::Dictionary &dictionary,
+                const std::string &board_file,
+                const std::string &static_environment_file,
+                const std::string &database_file)
+    -> std::shared_ptr<const world::WorldModel> {
+    if (!database_file.empty()) {
+        std::vector<std::string> sources{};
+        if (!board_file.empty() && !static_environment_file.empty()) {
+            sources = {board_file, static_environment_file};
+        }
+        return board_database::load_model(dictionary, database_file, sources);
+    }
+
+    std::ifstream board_stream{board_file};
+    if (!board_stream) {
+        throw std::runtime_error{"Failed to open board file " + board_file};
+    }
+    const auto boards{nlohmann::json::parse(board_stream)
+                          .get<std::vector<board::ConcreteBoard>>()};
+
+    std::ifstream static_env_stream{static_environment_file};
+    if (!static_env_stream) {
+        throw std::runtime_error{"Failed to open static environment file " +
+                                 static_environment_file};
+    }
+    world::BoardPlacement static_environment{};
+    world::from_json(nlohmann::json::parse(static_env_stream),
+                     static_environment);
+    board_database::StaticPlacements static_placements{};
+    for (const auto &[id, placement] : static_environment) {
+        static_placements.emplace_back(id, placement);
+    }
+
+    auto model{std::make_shared<world::WorldModel>(dictionary)};
+    for (const auto &concrete_board : boards) {
+        std::visit(
+            [&model](const auto &settings) {
+                model->addBoard(board::make_board(settings));
+            },
+            concrete_board);
+    }
+    model->makeStatic(static_placements);
+    return model;
+}
+
+void capture_frames(cv::VideoCapture &capture,
+                    frame_scheduler::FrameScheduler *scheduler,
+                    const std::atomic<bool> &stop,
+                    channel::Channel<CapturedFrame> &frames) {
+    while (!stop && capture.isOpened()) {
+        if (!capture.grab()) {
+            break;
+        }
+
+        // A paced video plays as if each frame was captured when it is due.
+        auto capture_time{frame_scheduler::Clock::now()};
+        if (scheduler != nullptr) {
+            const std::chrono::duration<double, std::milli> timestamp{
+                capture.get(cv::CAP_PROP_POS_MSEC)};
+            const auto release_time{scheduler->schedule(
+                std::chrono::duration_cast<frame_scheduler::Clock::duration>(
+                    timestamp),
+                frame_scheduler::Clock::now())};
+            // Dropped frames are only grabbed, which skips converting them.
+            if (!release_time) {
+                continue;
+            }
+            std::this_thread::sleep_until(*release_time);
+            capture_time = *release_time;
+        }
+
+        // NOTE: The previous frame may still be in use by a later stage, so
+        // always decode into a fresh buffer.
+        cv::Mat image{};
+        if (!capture.retrieve(image) ||
+            !frames.push({std::move(image), capture_time})) {
+            break;
+        }
+    }
+    frames.close();
+}
+
+void stream_poses(const pose_predictor::PosePredictor &predictor,
+                  const affine_rotation::AffineRotation &camera_to_drone,
+                  pose_predictor::Clock::duration period,
+                  const std::atomic<bool> &stop, mavlink::PoseSender &sender) {
+    auto next_time{pose_predictor::Clock::now()};
+    while (!stop) {
+        if (const auto camera_to_world{predictor.predict(next_time)}) {
+            sender.post(mavlink::drone_position_estimate(
+                camera_to_drone, *camera_to_world, next_time));
+        }
+        next_time += period;
+        std::this_thread::sleep_until(next_time);
+    }
+}
+
+auto send_reporting_failures(mavsdk::Mocap &mocap)
+    -> mavlink::PoseSender::Send {
+    return [&mocap](const mavsdk::Mocap::VisionPositionEstimate &estimate) {
+        const auto result{mocap.set_vision_position_estimate(estimate)};
+        if (result != mavsdk::Mocap::Result::Success) {
+            std::cerr << "Failed to send Mocap data: " << result << '\n';
+        }
+        return result;
+    };
+}
+
+} // namespace bananas::app_support
@@ -0,0 +1,337 @@
+#include <bananas_aruco/board_database.h>
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <gsl/assert>
+#include <gsl/span>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <opencv2/core/types.hpp>
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/board.h>
+#include <bananas_aruco/world.h>
+
+namespace bananas::board_database {
+
+namespace {
+
+constexpr std::array<char, 4> magic{'B', 'N', 'B', 'D'};
+/// Written in the native byte order, so that a file from a machine with
+/// another byte order reads as a different value.
+constexpr std::uint32_t byte_order_mark{0x01020304};
+constexpr std::uint64_t fnv1a_prime{0x100000001b3ULL};
+
+constexpr std::size_t corners_per_marker{4};
+constexpr std::size_t floats_per_corner{3};
+
+// Offsets of the header fields.
+constexpr std::size_t magic_offset{0};
+constexpr std::size_t byte_order_offset{4};
+constexpr std::size_t version_offset{8};
+constexpr std::size_t checksum_offset{16};
+constexpr std::size_t board_count_offset{24};
+constexpr std::size_t static_count_offset{28};
+constexpr std::size_t marker_count_offset{32};
+constexpr std::size_t header_size{40};
+
+// The board table has the first marker and the marker count of each board.
+constexpr std::size_t board_record_size{2 * sizeof(std::uint32_t)};
+constexpr std::size_t marker_id_size{sizeof(std::int32_t)};
+constexpr std::size_t marker_corners_size{corners_per_marker *
+                                          floats_per_corner * sizeof(float)};
+// A static placement has the board ID, the rotation as w, x, y, z and the
+// translation.
+constexpr std::size_t static_record_size{sizeof(std::uint32_t) +
+                                         (7 * sizeof(float))};
+
+template <typename T> void put(std::ostream &output, T value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    std::array<char, sizeof(T)> bytes{};
+    std::memcpy(bytes.data(), &value, sizeof(T));
+    output.write(bytes.data(), bytes.size());
+}
+
+/// Throw if @p condition doesn't hold for the file being loaded.
+void check(bool condition, const std::string &path, const char *problem) {
+    if (!condition) {
+        throw std::runtime_error{"Invalid board database " + path + ": " +
+                                 problem};
+    }
+}
+
+} // namespace
+
+auto fnv1a(gsl::span<const std::byte> data, std::uint64_t hash)
+    -> std::uint64_t {
+    for (const auto byte : data) {
+        hash ^= static_cast<std::uint64_t>(byte);
+        hash *= fnv1a_prime;
+    }
+    return hash;
+}
+
+auto source_checksum(gsl::span<const std::string> paths) -> std::uint64_t {
+    std::uint64_t hash{fnv1a_offset_basis};
+    std::vector<char> contents{};
+    for (const auto &path : paths) {
+        std::ifstream input{path, std::ios::binary};
+        if (!input) {
+            throw std::runtime_error{"Failed to open " + path};
+        }
+        contents.assign(std::istreambuf_iterator<char>{input},
+                        std::istreambuf_iterator<char>{});
+        if (input.bad()) {
+            throw std::runtime_error{"Failed to read " + path};
+        }
+        // Hash the length too, so that moving bytes from one file to the
+        // next changes the checksum.
+        const auto length{static_cast<std::uint64_t>(contents.size())};
+        hash = fnv1a(
+            gsl::as_bytes(gsl::span<const std::uint64_t>{&length, 1}), hash);
+        hash = fnv1a(gsl::as_bytes(gsl::span<const char>{contents}), hash);
+    }
+    return hash;
+}
+
+void write(std::ostream &output, gsl::span<const board::Board> boards,
+           gsl::span<const std::pair<world::BoardId,
+                                     affine_rotation::AffineRotation>>
+               static_placements,
+           std::uint64_t source_checksum) {
+    std::uint64_t marker_count{0};
+    for (const auto &board : boards) {
+        Expects(board.obj_points.size() == board.marker_ids.size());
+        marker_count += board.marker_ids.size();
+    }
+
+    output.write(magic.data(), magic.size());
+    put(output, byte_order_mark);
+    put(output, format_version);
+    put(output, std::uint32_t{0});
+    put(output, source_checksum);
+    put(output, static_cast<std::uint32_t>(boards.size()));
+    put(output, static_cast<std::uint32_t>(static_placements.size()));
+    put(output, marker_count);
+
+    std::uint32_t first_marker{0};
+    for (const auto &board : boards) {
+        const auto count{static_cast<std::uint32_t>(board.marker_ids.size())};
+        put(output, first_marker);
+        put(output, count);
+        first_marker += count;
+    }
+    for (const auto &board : boards) {
+        for (const int id : board.marker_ids) {
+            put(output, static_cast<std::int32_t>(id));
+        }
+    }
+    for (const auto &board : boards) {
+        for (const auto &corners : board.obj_points) {
+            Expects(corners.size() == corners_per_marker);
+            for (const auto &corner : corners) {
+                put(output, corner.x);
+                put(output, corner.y);
+                put(output, corner.z);
+            }
+        }
+    }
+    for (const auto &[id, placement] : static_placements) {
+        Expects(id < boards.size());
+        put(output, static_cast<std::uint32_t>(id));
+        const auto rotation{placement.getRotation()};
+        const auto translation{placement.getTranslation()};
+        for (const float value :
+             {rotation.w(), rotation.x(), rotation.y(), rotation.z(),
+              translation.x(), translation.y(), translation.z()}) {
+            put(output, value);
+        }
+    }
+}
+
+template <typename T>
+auto BoardDatabase::read(std::size_t offset) const -> T {
+    static_assert(std::is_trivially_copyable_v<T>);
+    Expects(offset + sizeof(T) <= size_);
+    T value{};
+    // The mapped data has no alignment guarantees beyond the start of the
+    // file, so copy it out instead of casting pointers.
+    std::memcpy(&value, data_ + offset, sizeof(T));
+    return value;
+}
+
+BoardDatabase::BoardDatabase(const std::string &path) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+    const int fd{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (fd < 0) {
+        throw std::system_error{errno, std::generic_category(),
+                                "Failed to open " + path};
+    }
+    struct stat status {};
+    if (::fstat(fd, &status) != 0) {
+        const int error{errno};
+        ::close(fd);
+        throw std::system_error{error, std::generic_category(),
+                                "Failed to stat " + path};
+    }
+    size_ = static_cast<std::size_t>(status.st_size);
+    if (size_ < header_size) {
+        ::close(fd);
+        throw std::runtime_error{"Invalid board database " + path +
+                                 ": the file is too short"};
+    }
+    void *const mapping{
+        ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0)};
+    const int map_error{errno};
+    // The mapping stays valid after closing the file.
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::system_error{map_error, std::generic_category(),
+                                "Failed to map " + path};
+    }
+    data_ = static_cast<const std::byte *>(mapping);
+
+    try {
+        const auto file_magic{read<std::array<char, 4>>(magic_offset)};
+        check(file_magic == magic, path, "not a board database");
+        check(read<std::uint32_t>(byte_order_offset) == byte_order_mark, path,
+              "compiled on a machine with another byte order");
+        check(read<std::uint32_t>(version_offset) == format_version, path,
+              "unsupported format version, recompile it");
+        source_checksum_ = read<std::uint64_t>(checksum_offset);
+        board_count_ = read<std::uint32_t>(board_count_offset);
+        static_count_ = read<std::uint32_t>(static_count_offset);
+        const auto marker_count{read<std::uint64_t>(marker_count_offset)};
+        // Each marker takes dozens of bytes, so this also keeps the size
+        // computation below from overflowing.
+        check(marker_count <= size_, path, "the file is truncated");
+        marker_count_ = static_cast<std::size_t>(marker_count);
+        check(size_ == header_size + (board_count_ * board_record_size) +
+                           (marker_count_ *
+                            (marker_id_size + marker_corners_size)) +
+                           (static_count_ * static_record_size),
+              path, "the file size doesn't match its header");
+
+        std::size_t next_marker{0};
+        for (std::size_t id{0}; id < board_count_; ++id) {
+            const auto offset{header_size + (id * board_record_size)};
+            const auto first{read<std::uint32_t>(offset)};
+            const auto count{
+                read<std::uint32_t>(offset + sizeof(std::uint32_t))};
+            check(first == next_marker, path, "the board table is corrupt");
+            next_marker += count;
+        }
+        check(next_marker == marker_count_, path,
+              "the board table is corrupt");
+
+        const auto static_offset{
+            header_size + (board_count_ * board_record_size) +
+            (marker_count_ * (marker_id_size + marker_corners_size))};
+        for (std::size_t i{0}; i < static_count_; ++i) {
+            check(read<std::uint32_t>(static_offset +
+                                      (i * static_record_size)) <
+                      board_count_,
+                  path, "a static placement refers to a missing board");
+        }
+    } catch (...) {
+        ::munmap(const_cast<std::byte *>(data_), size_);
+        throw;
+    }
+}
+
+BoardDatabase::~BoardDatabase() {
+    ::munmap(const_cast<std::byte *>(data_), size_);
+}
+
+auto BoardDatabase::board(world::BoardId id) const -> board::Board {
+    Expects(id < board_count_);
+    const auto record_offset{header_size + (id * board_record_size)};
+    const std::size_t first{read<std::uint32_t>(record_offset)};
+    const std::size_t count{
+        read<std::uint32_t>(record_offset + sizeof(std::uint32_t))};
+
+    const auto ids_offset{header_size + (board_count_ * board_record_size)};
+    const auto corners_offset{ids_offset + (marker_count_ * marker_id_size)};
+    board::Board board{};
+    board.marker_ids.reserve(count);
+    board.obj_points.reserve(count);
+    for (std::size_t marker{first}; marker < first + count; ++marker) {
+        board.marker_ids.push_back(
+            read<std::int32_t>(ids_offset + (marker * marker_id_size)));
+        const auto floats{read<
+            std::array<float, corners_per_marker * floats_per_corner>>(
+            corners_offset + (marker * marker_corners_size))};
+        auto &corners{board.obj_points.emplace_back()};
+        corners.reserve(corners_per_marker);
+        for (std::size_t i{0}; i < floats.size(); i += floats_per_corner) {
+            corners.emplace_back(floats[i], floats[i + 1], floats[i + 2]);
+        }
+    }
+    return board;
+}
+
+auto BoardDatabase::staticPlacements() const -> StaticPlacements {
+    const auto static_offset{
+        header_size + (board_count_ * board_record_size) +
+        (marker_count_ * (marker_id_size + marker_corners_size))};
+    StaticPlacements placements{};
+    placements.reserve(static_count_);
+    for (std::size_t i{0}; i < static_count_; ++i) {
+        const auto offset{static_offset + (i * static_record_size)};
+        const auto values{
+            read<std::array<float, 7>>(offset + sizeof(std::uint32_t))};
+        placements.emplace_back(
+            read<std::uint32_t>(offset),
+            affine_rotation::AffineRotation{
+                {values[0], values[1], values[2], values[3]},
+                {values[4], values[5], values[6]}});
+    }
+    return placements;
+}
+
+auto make_model(const cv::aruco::Dictionary &dictionary,
+                const BoardDatabase &database)
+    -> std::shared_ptr<world::WorldModel> {
+    auto model{std::make_shared<world::WorldModel>(dictionary)};
+    for (world::BoardId id{0}; id < database.boardCount(); ++id) {
+        model->addBoard(database.board(id));
+    }
+    model->makeStatic(database.staticPlacements());
+    return model;
+}
+
+auto load_model(const cv::aruco::Dictionary &dictionary,
+                const std::string &path, gsl::span<const std::string> sources)
+    -> std::shared_ptr<world::WorldModel> {
+    const BoardDatabase database{path};
+    if (!sources.empty() &&
+        database.sourceChecksum() != source_checksum(sources)) {
+        throw std::runtime_error{"The board database " + path +
+                                 " is out of date, recompile it"};
+    }
+    return make_model(dictionary, database);
+}
+
+} // namespace bananas::board_database
@@ -0,0 +1,20 @@
+#include <bananas_aruco/camera_config.h>
+
+#include <initializer_list>
+
+#include <opencv2/core/mat.hpp>
+
+namespace bananas::camera_config {
+
+auto camera_matrix(const CameraConfiguration &camera) -> cv::Mat {
+    return {{3, 3},
+            std::initializer_list<float>{
+                camera.focal_length_x, 0, camera.optical_center_x, 0,
+                camera.focal_length_y, camera.optical_center_y, 0, 0, 1}};
+}
+
+auto distortion_coefficients(const CameraConfiguration &camera) -> cv::Mat {
+    return {camera.distortion_coefficients, true};
+}
+
+} // namespace bananas::camera_config
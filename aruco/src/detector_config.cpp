@@ -0,0 +1,210 @@
+#include <bananas_aruco/detector_config.h>
+
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+#include <opencv2/objdetect/aruco_detector.hpp>
+
+namespace bananas::detector_config {
+
+namespace {
+
+const std::array<std::pair<cv::aruco::CornerRefineMethod, const char *>, 4>
+    corner_refine_methods{{{cv::aruco::CORNER_REFINE_NONE, "none"},
+                           {cv::aruco::CORNER_REFINE_SUBPIX, "subpix"},
+                           {cv::aruco::CORNER_REFINE_CONTOUR, "contour"},
+                           {cv::aruco::CORNER_REFINE_APRILTAG, "apriltag"}}};
+
+auto corner_refine_method(const std::string &name) -> int {
+    for (const auto &[method, method_name] : corner_refine_methods) {
+        if (name == method_name) {
+            return method;
+        }
+    }
+    throw std::invalid_argument{"Unknown corner refinement method " + name};
+}
+
+auto corner_refine_method_name(int method) -> std::string {
+    for (const auto &[known_method, name] : corner_refine_methods) {
+        if (method == known_method) {
+            return name;
+        }
+    }
+    throw std::invalid_argument{"Unknown corner refinement method " +
+                                std::to_string(method)};
+}
+
+/// Overwrite @p value with member @p key of @p j if there is one.
+template <typename T>
+void read_optional(const nlohmann::json &j, const char *key, T &value) {
+    const auto member{j.find(key)};
+    if (member != j.end()) {
+        member->get_to(value);
+    }
+}
+
+void read_detector_parameters(const nlohmann::json &j,
+                              cv::aruco::DetectorParameters &parameters) {
+    read_optional(j, "adaptive_thresh_win_size_min",
+                  parameters.adaptiveThreshWinSizeMin);
+    read_optional(j, "adaptive_thresh_win_size_max",
+                  parameters.adaptiveThreshWinSizeMax);
+    read_optional(j, "adaptive_thresh_win_size_step",
+                  parameters.adaptiveThreshWinSizeStep);
+    read_optional(j, "adaptive_thresh_constant",
+                  parameters.adaptiveThreshConstant);
+    read_optional(j, "min_marker_perimeter_rate",
+                  parameters.minMarkerPerimeterRate);
+    read_optional(j, "max_marker_perimeter_rate",
+                  parameters.maxMarkerPerimeterRate);
+    read_optional(j, "polygonal_approx_accuracy_rate",
+                  parameters.polygonalApproxAccuracyRate);
+    read_optional(j, "min_corner_distance_rate",
+                  parameters.minCornerDistanceRate);
+    read_optional(j, "min_distance_to_border", parameters.minDistanceToBorder);
+    read_optional(j, "min_marker_distance_rate",
+                  parameters.minMarkerDistanceRate);
+    const auto method{j.find("corner_refinement_method")};
+    if (method != j.end()) {
+        parameters.cornerRefinementMethod =
+            corner_refine_method(method->get<std::string>());
+    }
+    read_optional(j, "corner_refinement_win_size",
+                  parameters.cornerRefinementWinSize);
+    read_optional(j, "corner_refinement_max_iterations",
+                  parameters.cornerRefinementMaxIterations);
+    read_optional(j, "corner_refinement_min_accuracy",
+                  parameters.cornerRefinementMinAccuracy);
+    read_optional(j, "marker_border_bits", parameters.markerBorderBits);
+    read_optional(j, "perspective_remove_pixel_per_cell",
+                  parameters.perspectiveRemovePixelPerCell);
+    read_optional(j, "perspective_remove_ignored_margin_per_cell",
+                  parameters.perspectiveRemoveIgnoredMarginPerCell);
+    read_optional(j, "max_erroneous_bits_in_border_rate",
+                  parameters.maxErroneousBitsInBorderRate);
+    read_optional(j, "min_otsu_std_dev", parameters.minOtsuStdDev);
+    read_optional(j, "error_correction_rate", parameters.errorCorrectionRate);
+    read_optional(j, "use_aruco3_detection", parameters.useAruco3Detection);
+    read_optional(j, "min_side_length_canonical_img",
+                  parameters.minSideLengthCanonicalImg);
+    read_optional(j, "min_marker_length_ratio_original_img",
+                  parameters.minMarkerLengthRatioOriginalImg);
+}
+
+void read_refine_parameters(const nlohmann::json &j,
+                            cv::aruco::RefineParameters &parameters) {
+    read_optional(j, "min_rep_distance", parameters.minRepDistance);
+    read_optional(j, "error_correction_rate", parameters.errorCorrectionRate);
+    read_optional(j, "check_all_orders", parameters.checkAllOrders);
+}
+
+} // namespace
+
+auto preset(const std::string &name) -> DetectorConfig {
+    DetectorConfig config{};
+    if (name == "default") {
+        return config;
+    }
+    if (name == "fast") {
+        // Threshold the image only twice and skip corner refinement. The
+        // ArUco3 approach detects on a downscaled image when the markers are
+        // known to be large enough.
+        config.detector.adaptiveThreshWinSizeMin = 5;
+        config.detector.adaptiveThreshWinSizeMax = 15;
+        config.detector.adaptiveThreshWinSizeStep = 10;
+        config.detector.minMarkerPerimeterRate = 0.05F;
+        config.detector.cornerRefinementMethod = cv::aruco::CORNER_REFINE_NONE;
+        config.detector.useAruco3Detection = true;
+        config.refine.checkAllOrders = false;
+        return config;
+    }
+    if (name == "accurate") {
+        // Try more threshold windows to find markers in uneven lighting, and
+        // refine the corners to subpixel accuracy.
+        config.detector.adaptiveThreshWinSizeMin = 3;
+        config.detector.adaptiveThreshWinSizeMax = 33;
+        config.detector.adaptiveThreshWinSizeStep = 5;
+        config.detector.minMarkerPerimeterRate = 0.02F;
+        config.detector.cornerRefinementMethod =
+            cv::aruco::CORNER_REFINE_SUBPIX;
+        config.detector.cornerRefinementMaxIterations = 50;
+        config.detector.cornerRefinementMinAccuracy = 0.01F;
+        config.refine.minRepDistance = 15.0F;
+        return config;
+    }
+    throw std::invalid_argument{"Unknown detector preset " + name};
+}
+
+void from_json(const nlohmann::json &j, DetectorConfig &config) {
+    if (j.is_string()) {
+        config = preset(j.get<std::string>());
+        return;
+    }
+
+    config = preset(j.value("preset", std::string{"default"}));
+    const auto detector{j.find("detector")};
+    if (detector != j.end()) {
+        read_detector_parameters(*detector, config.detector);
+    }
+    const auto refine{j.find("refine")};
+    if (refine != j.end()) {
+        read_refine_parameters(*refine, config.refine);
+    }
+}
+
+void to_json(nlohmann::json &j, const DetectorConfig &config) {
+    const auto &detector{config.detector};
+    const auto &refine{config.refine};
+    j = {
+        {"detector",
+         {
+             {"adaptive_thresh_win_size_min",
+              detector.adaptiveThreshWinSizeMin},
+             {"adaptive_thresh_win_size_max",
+              detector.adaptiveThreshWinSizeMax},
+             {"adaptive_thresh_win_size_step",
+              detector.adaptiveThreshWinSizeStep},
+             {"adaptive_thresh_constant", detector.adaptiveThreshConstant},
+             {"min_marker_perimeter_rate", detector.minMarkerPerimeterRate},
+             {"max_marker_perimeter_rate", detector.maxMarkerPerimeterRate},
+             {"polygonal_approx_accuracy_rate",
+              detector.polygonalApproxAccuracyRate},
+             {"min_corner_distance_rate", detector.minCornerDistanceRate},
+             {"min_distance_to_border", detector.minDistanceToBorder},
+             {"min_marker_distance_rate", detector.minMarkerDistanceRate},
+             {"corner_refinement_method",
+              corner_refine_method_name(detector.cornerRefinementMethod)},
+             {"corner_refinement_win_size", detector.cornerRefinementWinSize},
+             {"corner_refinement_max_iterations",
+              detector.cornerRefinementMaxIterations},
+             {"corner_refinement_min_accuracy",
+              detector.cornerRefinementMinAccuracy},
+             {"marker_border_bits", detector.markerBorderBits},
+             {"perspective_remove_pixel_per_cell",
+              detector.perspectiveRemovePixelPerCell},
+             {"perspective_remove_ignored_margin_per_cell",
+              detector.perspectiveRemoveIgnoredMarginPerCell},
+             {"max_erroneous_bits_in_border_rate",
+              detector.maxErroneousBitsInBorderRate},
+             {"min_otsu_std_dev", detector.minOtsuStdDev},
+             {"error_correction_rate", detector.errorCorrectionRate},
+             {"use_aruco3_detection", detector.useAruco3Detection},
+             {"min_side_length_canonical_img",
+              detector.minSideLengthCanonicalImg},
+             {"min_marker_length_ratio_original_img",
+              detector.minMarkerLengthRatioOriginalImg},
+         }},
+        {"refine",
+         {
+             {"min_rep_distance", refine.minRepDistance},
+             {"error_correction_rate", refine.errorCorrectionRate},
+             {"check_all_orders", refine.checkAllOrders},
+         }},
+    };
+}
+
+} // namespace bananas::detector_config
@@ -0,0 +1,29 @@
+#include <bananas_aruco/frame_scheduler.h>
+
+#include <optional>
+
+#include <gsl/assert>
+
+namespace bananas::frame_scheduler {
+
+FrameScheduler::FrameScheduler(Clock::duration latency_budget)
+    : latency_budget_{latency_budget} {
+    Expects(latency_budget >= Clock::duration::zero());
+}
+
+auto FrameScheduler::schedule(Clock::duration timestamp, Clock::time_point now)
+    -> std::optional<Clock::time_point> {
+    if (!start_) {
+        start_ = now - timestamp;
+    }
+
+    const auto due{*start_ + timestamp};
+    if (now > due + latency_budget_) {
+        ++statistics_.dropped;
+        return {};
+    }
+    ++statistics_.processed;
+    return due;
+}
+
+} // namespace bananas::frame_scheduler
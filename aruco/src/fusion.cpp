@@ -0,0 +1,127 @@
+#include <bananas_aruco/fusion.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <gsl/assert>
+#include <gsl/span>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/world.h>
+
+namespace bananas::fusion {
+
+namespace {
+
+/// Reprojection errors below this many pixels are mostly noise, so they
+/// don't earn a pose any more weight.
+constexpr float min_reprojection_error{0.5F};
+
+auto weight(const world::UncertainPose &pose) -> float {
+    const float error{
+        std::max(pose.reprojection_error, min_reprojection_error)};
+    return 1.0F / (error * error);
+}
+
+} // namespace
+
+auto average(gsl::span<const world::UncertainPose> poses)
+    -> world::UncertainPose {
+    Expects(!poses.empty());
+    if (poses.size() == 1) {
+        return poses.front();
+    }
+
+    const auto reference{poses.front().placement.getRotation()};
+    float total_weight{0.0F};
+    float error{0.0F};
+    Eigen::Vector3f translation{Eigen::Vector3f::Zero()};
+    Eigen::Vector4f rotation{Eigen::Vector4f::Zero()};
+    for (const auto &pose : poses) {
+        const float pose_weight{weight(pose)};
+        total_weight += pose_weight;
+        error += pose_weight * pose.reprojection_error;
+        translation += pose_weight * pose.placement.getTranslation();
+        // q and -q are the same rotation, so flip the quaternions into the
+        // same hemisphere before summing them up.
+        const auto pose_rotation{pose.placement.getRotation()};
+        const float sign{pose_rotation.dot(reference) < 0.0F ? -1.0F : 1.0F};
+        rotation += sign * pose_weight * pose_rotation.coeffs();
+    }
+
+    return {error / total_weight,
+            {Eigen::Quaternionf{rotation}.normalized(),
+             translation / total_weight}};
+}
+
+Fuser::Fuser(std::vector<affine_rotation::AffineRotation> camera_to_drone,
+             Clock::duration max_skew)
+    : camera_to_drone_{std::move(camera_to_drone)}, max_skew_{max_skew},
+      latest_(camera_to_drone_.size()) {
+    Expects(!camera_to_drone_.empty());
+    Expects(max_skew >= Clock::duration::zero());
+}
+
+void Fuser::update(std::size_t camera, const world::FitResult &result,
+                   FusedResult &fused) {
+    Expects(camera < latest_.size());
+
+    auto &state{latest_[camera]};
+    if (!state) {
+        state.emplace();
+    }
+    state->capture_time = result.capture_time;
+    state->drone_to_world.reset();
+    if (result.camera_to_world) {
+        state->drone_to_world = world::UncertainPose{
+            result.camera_to_world->reprojection_error,
+            result.camera_to_world->placement *
+                camera_to_drone_[camera].inverse()};
+    }
+    state->dynamic_board_placements = result.dynamic_board_placements;
+
+    drone_poses_.clear();
+    for (auto [id, poses] : board_poses_) {
+        poses.clear();
+    }
+    fused.drone_to_world.reset();
+    fused.dynamic_board_placements.clear();
+    fused.capture_time = result.capture_time;
+    fused.camera_count = 0;
+
+    for (const auto &other : latest_) {
+        // Results from the future can only come from cameras whose threads
+        // are running ahead of this one.
+        if (!other || other->capture_time < result.capture_time - max_skew_ ||
+            other->capture_time > result.capture_time + max_skew_) {
+            continue;
+        }
+        ++fused.camera_count;
+        fused.capture_time = std::max(fused.capture_time, other->capture_time);
+        if (other->drone_to_world) {
+            drone_poses_.push_back(*other->drone_to_world);
+        }
+        for (const auto &[id, pose] : other->dynamic_board_placements) {
+            board_poses_.emplace(id, {});
+            board_poses_.at(id).push_back(pose);
+        }
+    }
+
+    if (!drone_poses_.empty()) {
+        fused.drone_to_world = average(drone_poses_);
+    }
+    for (const auto &[id, poses] : board_poses_) {
+        if (!poses.empty()) {
+            fused.dynamic_board_placements.insert_or_assign(id,
+                                                            average(poses));
+        }
+    }
+}
+
+} // namespace bananas::fusion
@@ -0,0 +1,85 @@
+#include <bananas_aruco/marker_index.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gsl/assert>
+
+namespace bananas::world {
+
+MarkerIndex::MarkerIndex(std::size_t dictionary_size)
+    : locations_(dictionary_size) {}
+
+void MarkerIndex::addBoard(BoardId board, const std::vector<int> &marker_ids) {
+    Expects(board == board_count_);
+
+    for (std::size_t i{0}; i < marker_ids.size(); ++i) {
+        const int id{marker_ids[i]};
+        if (id < 0 || static_cast<std::size_t>(id) >= locations_.size()) {
+            throw std::invalid_argument{"Marker ID " + std::to_string(id) +
+                                        " is not in the dictionary"};
+        }
+        const auto &existing{locations_[static_cast<std::size_t>(id)]};
+        if (existing) {
+            throw std::invalid_argument{
+                "Marker ID " + std::to_string(id) + " of board " +
+                std::to_string(board) + " is already used by board " +
+                std::to_string(existing->board)};
+        }
+        for (std::size_t j{0}; j < i; ++j) {
+            if (marker_ids[j] == id) {
+                throw std::invalid_argument{
+                    "Marker ID " + std::to_string(id) +
+                    " appears multiple times in board " +
+                    std::to_string(board)};
+            }
+        }
+    }
+
+    for (std::size_t i{0}; i < marker_ids.size(); ++i) {
+        locations_[static_cast<std::size_t>(marker_ids[i])] =
+            MarkerLocation{board, static_cast<std::uint32_t>(i)};
+    }
+    ++board_count_;
+}
+
+auto MarkerIndex::find(int marker_id) const -> std::optional<MarkerLocation> {
+    if (marker_id < 0 ||
+        static_cast<std::size_t>(marker_id) >= locations_.size()) {
+        return {};
+    }
+    return locations_[static_cast<std::size_t>(marker_id)];
+}
+
+void MarkerIndex::partition(const std::vector<int> &ids,
+                            DetectionBuckets &buckets) const {
+    // Only clear the buckets that were used last time to keep this
+    // proportional to the number of detections.
+    for (const auto board : buckets.boards) {
+        if (board < buckets.matches.size()) {
+            buckets.matches[board].clear();
+        }
+    }
+    buckets.boards.clear();
+    buckets.matches.resize(board_count_);
+
+    for (std::size_t detection{0}; detection < ids.size(); ++detection) {
+        const auto location{find(ids[detection])};
+        if (!location) {
+            continue;
+        }
+        auto &matches{buckets.matches[location->board]};
+        if (matches.empty()) {
+            buckets.boards.push_back(location->board);
+        }
+        matches.push_back({detection, location->marker});
+    }
+}
+
+auto MarkerIndex::boardCount() const -> std::size_t { return board_count_; }
+
+} // namespace bananas::world
@@ -1,18 +1,39 @@
 #include <bananas_aruco/mavlink.h>
 
+#include <chrono>
+#include <cstdint>
 #include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include <gsl/assert>
 
 #include <mavsdk/plugins/mocap/mocap.h>
 
 #include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/profiling.h>
 #include <bananas_aruco/world.h>
 
 namespace bananas::mavlink {
 
+auto timestamp_usec(std::chrono::steady_clock::time_point time)
+    -> std::uint64_t {
+    // MAVSDK keeps its own time on the steady clock, too.
+    const auto since_epoch{
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            time.time_since_epoch())};
+    // Zero would make MAVSDK stamp the estimate with the time of sending.
+    Expects(since_epoch.count() > 0);
+    return static_cast<std::uint64_t>(since_epoch.count());
+}
+
 mavsdk::Mocap::VisionPositionEstimate
 drone_position_estimate(const affine_rotation::AffineRotation &camera_to_drone,
-                        const world::UncertainPose &camera_to_world) {
+                        const world::UncertainPose &camera_to_world,
+                        std::chrono::steady_clock::time_point time) {
     mavsdk::Mocap::VisionPositionEstimate estimate{};
+    estimate.time_usec = timestamp_usec(time);
 
     Eigen::Matrix3f gltf_to_ned{};
     // clang-format off
@@ -40,4 +61,59 @@ drone_position_estimate(const affine_rotation::AffineRotation &camera_to_drone,
     return estimate;
 }
 
+PoseSender::PoseSender(Send send,
+                       std::chrono::steady_clock::duration min_interval)
+    : send_{std::move(send)}, min_interval_{min_interval},
+      thread_{[this] { run(); }} {
+    Expects(send_);
+    Expects(min_interval >= std::chrono::steady_clock::duration::zero());
+}
+
+PoseSender::PoseSender(mavsdk::Mocap &mocap,
+                       std::chrono::steady_clock::duration min_interval)
+    : PoseSender{[&mocap](const mavsdk::Mocap::VisionPositionEstimate
+                              &estimate) {
+                     return mocap.set_vision_position_estimate(estimate);
+                 },
+                 min_interval} {}
+
+PoseSender::~PoseSender() {
+    mailbox_.close();
+    thread_.join();
+}
+
+void PoseSender::post(mavsdk::Mocap::VisionPositionEstimate estimate) {
+    mailbox_.push(std::move(estimate));
+}
+
+auto PoseSender::statistics() const -> Statistics {
+    return {sent_.load(), mailbox_.dropped(), failed_.load()};
+}
+
+auto PoseSender::takeAges() -> profiling::LatencyHistogram {
+    const std::lock_guard lock{ages_mutex_};
+    return std::exchange(ages_, {});
+}
+
+void PoseSender::run() {
+    while (const auto estimate{mailbox_.pop()}) {
+        const auto send_time{std::chrono::steady_clock::now()};
+        if (estimate->time_usec != 0) {
+            const auto age{
+                send_time.time_since_epoch() -
+                std::chrono::microseconds{estimate->time_usec}};
+            const std::lock_guard lock{ages_mutex_};
+            ages_.record(age);
+        }
+        if (send_(*estimate) == mavsdk::Mocap::Result::Success) {
+            ++sent_;
+        } else {
+            ++failed_;
+        }
+        // Estimates posted in the meantime replace each other, so only the
+        // latest one gets sent after the pause.
+        std::this_thread::sleep_until(send_time + min_interval_);
+    }
+}
+
 } // namespace bananas::mavlink
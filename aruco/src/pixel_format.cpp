@@ -0,0 +1,57 @@
+#include <bananas_aruco/pixel_format.h>
+
+#include <gsl/assert>
+
+#include <opencv2/core/hal/interface.h>
+#include <opencv2/core/mat.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace bananas::pixel_format {
+
+namespace {
+
+auto is_yuv420(PixelFormat format) -> bool {
+    return format == PixelFormat::nv12 || format == PixelFormat::nv21 ||
+           format == PixelFormat::i420;
+}
+
+} // namespace
+
+auto luma(const cv::Mat &image, PixelFormat format, cv::Mat &buffer)
+    -> cv::Mat {
+    if (format == PixelFormat::bgr) {
+        Expects(image.type() == CV_8UC3);
+        cv::cvtColor(image, buffer, cv::COLOR_BGR2GRAY);
+        return buffer;
+    }
+
+    Expects(image.type() == CV_8UC1);
+    if (is_yuv420(format)) {
+        Expects(image.rows % 3 == 0);
+        // The Y plane is a full resolution greyscale image on its own.
+        return image.rowRange(0, image.rows / 3 * 2);
+    }
+    return image;
+}
+
+void to_bgr(const cv::Mat &image, PixelFormat format, cv::Mat &bgr) {
+    switch (format) {
+    case PixelFormat::bgr:
+        image.copyTo(bgr);
+        break;
+    case PixelFormat::gray:
+        cv::cvtColor(image, bgr, cv::COLOR_GRAY2BGR);
+        break;
+    case PixelFormat::nv12:
+        cv::cvtColor(image, bgr, cv::COLOR_YUV2BGR_NV12);
+        break;
+    case PixelFormat::nv21:
+        cv::cvtColor(image, bgr, cv::COLOR_YUV2BGR_NV21);
+        break;
+    case PixelFormat::i420:
+        cv::cvtColor(image, bgr, cv::COLOR_YUV2BGR_I420);
+        break;
+    }
+}
+
+} // namespace bananas::pixel_format
@@ -0,0 +1,130 @@
+#include <bananas_aruco/pose_predictor.h>
+
+#include <chrono>
+#include <mutex>
+#include <optional>
+
+#include <gsl/assert>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/world.h>
+
+namespace bananas::pose_predictor {
+
+namespace {
+
+/// Below this angle, rotations are treated as no rotation at all, which
+/// avoids normalizing a near-zero rotation axis.
+constexpr float min_angle{1E-6F};
+
+auto seconds(Clock::duration duration) -> float {
+    return std::chrono::duration<float>{duration}.count();
+}
+
+/// The rotation by @p rotation_vector, whose length is the angle in radians.
+auto from_rotation_vector(const Eigen::Vector3f &rotation_vector)
+    -> Eigen::Quaternionf {
+    const float angle{rotation_vector.norm()};
+    if (angle < min_angle) {
+        return Eigen::Quaternionf::Identity();
+    }
+    return Eigen::Quaternionf{
+        Eigen::AngleAxisf{angle, rotation_vector / angle}};
+}
+
+/// The rotation vector of @p rotation, taking the shorter way around.
+auto to_rotation_vector(Eigen::Quaternionf rotation) -> Eigen::Vector3f {
+    if (rotation.w() < 0.0F) {
+        rotation.coeffs() = -rotation.coeffs();
+    }
+    const Eigen::AngleAxisf angle_axis{rotation};
+    if (angle_axis.angle() < min_angle) {
+        return Eigen::Vector3f::Zero();
+    }
+    return angle_axis.axis() * angle_axis.angle();
+}
+
+} // namespace
+
+PosePredictor::PosePredictor(PredictorParameters parameters)
+    : parameters_{parameters} {
+    Expects(parameters_.max_horizon >= Clock::duration::zero());
+    Expects(parameters_.max_gap > Clock::duration::zero());
+    Expects(parameters_.velocity_smoothing > 0.0F &&
+            parameters_.velocity_smoothing <= 1.0F);
+}
+
+void PosePredictor::update(const world::UncertainPose &camera_to_world,
+                           Clock::time_point time) {
+    const std::lock_guard lock{mutex_};
+    // A late measurement would only drag the velocity backwards.
+    if (latest_ && time < latest_time_) {
+        return;
+    }
+
+    const auto elapsed{time - latest_time_};
+    if (latest_ && elapsed > Clock::duration::zero() &&
+        elapsed <= parameters_.max_gap) {
+        const auto &previous{latest_->placement};
+        const auto &current{camera_to_world.placement};
+        const float dt{seconds(elapsed)};
+        const Eigen::Vector3f linear_velocity{
+            (current.getTranslation() - previous.getTranslation()) / dt};
+        const Eigen::Vector3f angular_velocity{
+            to_rotation_vector(current.getRotation() *
+                               previous.getRotation().inverse()) /
+            dt};
+
+        // Exponential smoothing keeps the detection noise from being
+        // amplified into the extrapolated poses.
+        const float weight{has_velocity_ ? parameters_.velocity_smoothing
+                                         : 1.0F};
+        linear_velocity_ =
+            weight * linear_velocity + (1.0F - weight) * linear_velocity_;
+        angular_velocity_ =
+            weight * angular_velocity + (1.0F - weight) * angular_velocity_;
+        has_velocity_ = true;
+    } else if (elapsed > parameters_.max_gap) {
+        linear_velocity_.setZero();
+        angular_velocity_.setZero();
+        has_velocity_ = false;
+    }
+
+    latest_ = camera_to_world;
+    latest_time_ = time;
+}
+
+auto PosePredictor::predict(Clock::time_point time) const
+    -> std::optional<world::UncertainPose> {
+    const std::lock_guard lock{mutex_};
+    if (!latest_ || time > latest_time_ + parameters_.max_horizon) {
+        return {};
+    }
+    if (time <= latest_time_) {
+        return latest_;
+    }
+
+    const float dt{seconds(time - latest_time_)};
+    const auto &placement{latest_->placement};
+    const Eigen::Quaternionf rotation{
+        (from_rotation_vector(angular_velocity_ * dt) *
+         placement.getRotation())
+            .normalized()};
+    const Eigen::Vector3f translation{placement.getTranslation() +
+                                      linear_velocity_ * dt};
+    return world::UncertainPose{latest_->reprojection_error,
+                                {rotation, translation}};
+}
+
+void PosePredictor::reset() {
+    const std::lock_guard lock{mutex_};
+    latest_.reset();
+    linear_velocity_.setZero();
+    angular_velocity_.setZero();
+    has_velocity_ = false;
+}
+
+} // namespace bananas::pose_predictor
@@ -0,0 +1,125 @@
+#include <bananas_aruco/profiling.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <gsl/assert>
+
+#include <nlohmann/json.hpp>
+
+namespace bananas::profiling {
+
+namespace {
+
+auto to_milliseconds(Clock::duration duration) -> double {
+    return std::chrono::duration<double, std::milli>{duration}.count();
+}
+
+/// The names of the stages in the order of the Stage enumerators.
+constexpr std::array<std::string_view, stage_count> stage_names{
+    "detect",       "refine_corners", "refine_static",
+    "match",        "refine_dynamic", "undistort",
+    "solve_static", "solve_dynamic",  "total"};
+
+} // namespace
+
+void LatencyHistogram::record(Clock::duration latency) {
+    const auto value{static_cast<std::uint64_t>(
+        std::max(latency.count(), Clock::duration::rep{0}))};
+    const auto index{bucketIndex(value)};
+    if (index >= buckets_.size()) {
+        buckets_.resize(index + 1);
+    }
+    ++buckets_[index];
+    ++count_;
+    max_ = std::max(max_, value);
+}
+
+auto LatencyHistogram::percentile(double fraction) const -> Clock::duration {
+    Expects(fraction >= 0.0 && fraction <= 1.0);
+    if (count_ == 0) {
+        return Clock::duration::zero();
+    }
+
+    const auto rank{std::max(
+        std::uint64_t{1}, static_cast<std::uint64_t>(std::ceil(
+                              fraction * static_cast<double>(count_))))};
+    std::uint64_t seen{0};
+    for (std::size_t index{0}; index < buckets_.size(); ++index) {
+        seen += buckets_[index];
+        if (seen >= rank) {
+            return Clock::duration{std::min(bucketEnd(index), max_)};
+        }
+    }
+    return max();
+}
+
+// Values below sub_bucket_count get a bucket each. Above that, each range
+// [2^n, 2^(n+1)) is split into sub_bucket_count equally sized buckets.
+auto LatencyHistogram::bucketIndex(std::uint64_t value) -> std::size_t {
+    if (value < sub_bucket_count) {
+        return value;
+    }
+    std::size_t shift{0};
+    while ((value >> shift) >= 2 * sub_bucket_count) {
+        ++shift;
+    }
+    return ((shift + 1) * sub_bucket_count) +
+           ((value >> shift) - sub_bucket_count);
+}
+
+auto LatencyHistogram::bucketEnd(std::size_t index) -> std::uint64_t {
+    if (index < sub_bucket_count) {
+        return index;
+    }
+    const auto shift{index / sub_bucket_count - 1};
+    const auto start{(sub_bucket_count + index % sub_bucket_count) << shift};
+    return start + (std::uint64_t{1} << shift) - 1;
+}
+
+void to_json(nlohmann::json &j, const LatencyHistogram &histogram) {
+    j = {{"count", histogram.count()},
+         {"p50_ms", to_milliseconds(histogram.percentile(0.5))},
+         {"p99_ms", to_milliseconds(histogram.percentile(0.99))},
+         {"max_ms", to_milliseconds(histogram.max())}};
+}
+
+auto name(Stage stage) -> std::string_view {
+    return stage_names.at(static_cast<std::size_t>(stage));
+}
+
+#ifdef ENABLE_PROFILING
+
+auto FitProfile::timeBoard(world::BoardId board_id) -> ScopedTimer {
+    boards_.emplace(board_id, {});
+    return ScopedTimer{boards_.at(board_id)};
+}
+
+void to_json(nlohmann::json &j, const FitProfile &profile) {
+    auto stages = nlohmann::json::object();
+    for (std::size_t i{0}; i < stage_count; ++i) {
+        const auto stage{static_cast<Stage>(i)};
+        stages[std::string{name(stage)}] = profile.stage(stage);
+    }
+    auto boards = nlohmann::json::object();
+    for (const auto &[board_id, histogram] : profile.boards()) {
+        boards[std::to_string(board_id)] = histogram;
+    }
+    j = {{"stages", stages}, {"boards", boards}};
+}
+
+#else // ENABLE_PROFILING
+
+void to_json(nlohmann::json &j, const FitProfile & /*profile*/) {
+    j = nlohmann::json::object();
+}
+
+#endif // ENABLE_PROFILING
+
+} // namespace bananas::profiling
@@ -0,0 +1,172 @@
+#include <bananas_aruco/renderer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <gsl/assert>
+#include <gsl/span>
+
+#include <opencv2/calib3d.hpp>
+#include <opencv2/core.hpp>
+#include <opencv2/core/hal/interface.h>
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/board.h>
+
+namespace bananas::renderer {
+
+namespace {
+
+/// Markers closer to the camera than this are not drawn.
+constexpr float near_plane{0.01F};
+
+/// Return whether the marker with @p corners in the glTF camera coordinate
+/// system is in front of the camera and facing it.
+auto is_visible(const std::vector<cv::Point3f> &corners) -> bool {
+    if (corners.size() != 4 ||
+        std::any_of(corners.cbegin(), corners.cend(),
+                    [](const cv::Point3f &corner) {
+                        return corner.z < near_plane;
+                    })) {
+        return false;
+    }
+    // The corners go clockwise when seen from the front.
+    const auto normal{(corners[1] - corners[0]).cross(corners[3] - corners[0])};
+    return normal.dot(corners[0]) > 0.0F;
+}
+
+/// Return the map from each pixel of a distorted image to the pixel of the
+/// undistorted image that shows the same point.
+auto make_distortion_map(const cv::Mat &camera_matrix,
+                         const cv::Mat &distortion_coeffs,
+                         cv::Size image_size) -> cv::Mat {
+    std::vector<cv::Point2f> pixels{};
+    pixels.reserve(static_cast<std::size_t>(image_size.area()));
+    for (int y{0}; y < image_size.height; ++y) {
+        for (int x{0}; x < image_size.width; ++x) {
+            pixels.emplace_back(static_cast<float>(x), static_cast<float>(y));
+        }
+    }
+    std::vector<cv::Point2f> undistorted{};
+    cv::undistortPoints(
+        pixels, undistorted, camera_matrix, distortion_coeffs, cv::noArray(),
+        camera_matrix,
+        {cv::TermCriteria::COUNT | cv::TermCriteria::EPS, 20, 0.001});
+    return cv::Mat{undistorted, true}.reshape(2, image_size.height);
+}
+
+} // namespace
+
+Renderer::Renderer(cv::Mat camera_matrix, cv::Mat distortion_coeffs,
+                   cv::Size image_size,
+                   const cv::aruco::Dictionary &dictionary,
+                   const RenderParameters &parameters)
+    : camera_matrix_{std::move(camera_matrix)}, image_size_{image_size},
+      dictionary_{&dictionary}, parameters_{parameters} {
+    Expects(!image_size.empty());
+    Expects(parameters.blur_sigma >= 0.0 && parameters.noise_sigma >= 0.0);
+
+    if (!distortion_coeffs.empty() && cv::countNonZero(distortion_coeffs) > 0) {
+        distortion_map_ =
+            make_distortion_map(camera_matrix_, distortion_coeffs, image_size);
+    }
+}
+
+void Renderer::render(gsl::span<const BoardPose> boards, cv::Mat &image,
+                      std::uint64_t seed) const {
+    cv::Mat undistorted{image_size_, CV_8UC1,
+                        cv::Scalar{parameters_.background}};
+    std::vector<cv::Point3f> corners{};
+    for (const auto &[board, board_to_camera] : boards) {
+        for (std::size_t i{0}; i < board->obj_points.size(); ++i) {
+            const auto &marker{board->obj_points[i]};
+            corners.resize(marker.size());
+            board_to_camera.transform(marker, corners);
+            if (is_visible(corners)) {
+                drawMarker(undistorted, board->marker_ids[i], corners);
+            }
+        }
+    }
+
+    if (distortion_map_.empty()) {
+        image = std::move(undistorted);
+    } else {
+        cv::remap(undistorted, image, distortion_map_, cv::noArray(),
+                  cv::INTER_LINEAR, cv::BORDER_CONSTANT,
+                  cv::Scalar{parameters_.background});
+    }
+    if (parameters_.blur_sigma > 0.0) {
+        cv::GaussianBlur(image, image, {}, parameters_.blur_sigma);
+    }
+    if (parameters_.noise_sigma > 0.0) {
+        cv::Mat noise{image_size_, CV_16SC1};
+        cv::RNG rng{seed};
+        rng.fill(noise, cv::RNG::NORMAL, 0.0, parameters_.noise_sigma);
+        cv::add(image, noise, image, cv::noArray(), CV_8U);
+    }
+}
+
+auto Renderer::project(const std::vector<cv::Point3f> &points) const
+    -> std::vector<cv::Point2f> {
+    // The OpenCV camera coordinate system has X right and Y down.
+    std::vector<cv::Point3f> cv_points{};
+    cv_points.reserve(points.size());
+    for (const auto &point : points) {
+        cv_points.emplace_back(-point.x, -point.y, point.z);
+    }
+    std::vector<cv::Point2f> image_points{};
+    cv::projectPoints(cv_points, cv::Vec3f{}, cv::Vec3f{}, camera_matrix_,
+                      cv::noArray(), image_points);
+    return image_points;
+}
+
+void Renderer::drawMarker(cv::Mat &image, int id,
+                          const std::vector<cv::Point3f> &corners) const {
+    const auto image_corners{project(corners)};
+    const auto bounds{cv::boundingRect(image_corners) &
+                      cv::Rect{{0, 0}, image.size()}};
+    if (bounds.empty()) {
+        return;
+    }
+
+    // Sample the marker image at about the resolution it is drawn at.
+    float largest_side{0.0F};
+    for (std::size_t i{0}; i < image_corners.size(); ++i) {
+        const auto side{image_corners[(i + 1) % image_corners.size()] -
+                        image_corners[i]};
+        largest_side = std::max(largest_side, std::hypot(side.x, side.y));
+    }
+    constexpr int max_marker_pixels{1024};
+    const int marker_pixels{
+        std::clamp(static_cast<int>(std::ceil(largest_side)),
+                   dictionary_->markerSize + 2, max_marker_pixels)};
+    cv::Mat marker{};
+    cv::aruco::generateImageMarker(*dictionary_, id, marker_pixels, marker);
+
+    // Pixel centers are at integer coordinates, so the outer edges of the
+    // marker image are half a pixel outside of them. Only warp the part of
+    // the image that the marker covers.
+    const float low{-0.5F};
+    const float high{static_cast<float>(marker_pixels) - 0.5F};
+    const std::vector<cv::Point2f> marker_corners{
+        {low, low}, {high, low}, {high, high}, {low, high}};
+    std::vector<cv::Point2f> region_corners{};
+    region_corners.reserve(image_corners.size());
+    for (const auto &corner : image_corners) {
+        region_corners.push_back(corner - cv::Point2f{bounds.tl()});
+    }
+    const auto transform{
+        cv::getPerspectiveTransform(marker_corners, region_corners)};
+    cv::Mat region{image(bounds)};
+    cv::warpPerspective(marker, region, transform, region.size(),
+                        cv::INTER_LINEAR, cv::BORDER_TRANSPARENT);
+}
+
+} // namespace bananas::renderer
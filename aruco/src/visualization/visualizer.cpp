@@ -135,16 +135,14 @@ void Visualizer::update(const world::FitResult &fit) {
                   fit.camera_to_world->reprojection_error);
     }
     for (const auto &[id, object] : objects_) {
-        const auto object_placement{fit.dynamic_board_placements.find(id)};
-        const bool has_placement{object_placement !=
-                                 fit.dynamic_board_placements.cend()};
-        if (forced_visible_.find(id) == forced_visible_.end()) {
-            object.node->setVisible(has_placement);
+        const auto *const object_placement{
+            fit.dynamic_board_placements.find(id)};
+        if (!object.forced_visible) {
+            object.node->setVisible(object_placement != nullptr);
         }
-        if (has_placement) {
-            set_transform(object.node, object_placement->second.placement);
-            set_color(object.material,
-                      object_placement->second.reprojection_error);
+        if (object_placement != nullptr) {
+            set_transform(object.node, object_placement->placement);
+            set_color(object.material, object_placement->reprojection_error);
         }
     }
 }
@@ -166,7 +164,7 @@ void Visualizer::addObject(world::BoardId id, const board::BoxSettings &box) {
     node->attachObject(cube);
     node->setVisible(false);
 
-    objects_.emplace(id, ColoredObject{node, material});
+    objects_.emplace(id, ColoredObject{node, material, false});
 }
 
 void Visualizer::addObject(world::BoardId id, const board::GridSettings &grid) {
@@ -190,15 +188,15 @@ void Visualizer::addObject(world::BoardId id, const board::GridSettings &grid) {
     node->setScale(0.005F * board::grid_width(grid),
                    0.005F * board::grid_height(grid), 1.0F);
 
-    objects_.emplace(id, ColoredObject{node, material});
+    objects_.emplace(id, ColoredObject{node, material, false});
 }
 
 void Visualizer::forceVisible(world::BoardId id) {
-    const auto location{objects_.find(id)};
-    Expects(location != objects_.cend());
+    auto *const object{objects_.find(id)};
+    Expects(object != nullptr);
 
-    location->second.node->setVisible(true);
-    forced_visible_.insert(id);
+    object->node->setVisible(true);
+    object->forced_visible = true;
 }
 
 } // namespace bananas::visualizer
@@ -1,13 +1,23 @@
 #include <bananas_aruco/world.h>
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <iterator>
+#include <limits>
+#include <memory>
+#include <numeric>
 #include <optional>
+#include <stdexcept>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include <gsl/assert>
+#include <gsl/span>
 
 #include <nlohmann/json.hpp>
 
@@ -15,15 +25,21 @@
 #include <Eigen/Geometry>
 
 #include <opencv2/calib3d.hpp>
+#include <opencv2/core.hpp>
 #include <opencv2/core/hal/interface.h>
 #include <opencv2/core/mat.hpp>
 #include <opencv2/core/matx.hpp>
 #include <opencv2/core/types.hpp>
+#include <opencv2/imgproc.hpp>
 #include <opencv2/objdetect/aruco_board.hpp>
 #include <opencv2/objdetect/aruco_dictionary.hpp>
 
 #include <bananas_aruco/affine_rotation.h>
 #include <bananas_aruco/board.h>
+#include <bananas_aruco/detector_config.h>
+#include <bananas_aruco/marker_index.h>
+#include <bananas_aruco/pixel_format.h>
+#include <bananas_aruco/profiling.h>
 
 namespace bananas::world {
 
@@ -33,10 +49,129 @@ struct PlacementJson {
     std::uint32_t id{};
     affine_rotation::AffineRotation board_to_world{};
 };
-// Mark to_json as potentially unused to make clang happy. This is ugly, but it
-// works.
-[[maybe_unused]] NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(PlacementJson, id,
-                                                    board_to_world);
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(PlacementJson, id, board_to_world);
+
+/// Convert a board-to-camera pose from solvePnP() into our conventions.
+auto to_gltf(const cv::Vec3f &rvec,
+             const cv::Vec3f &tvec) -> affine_rotation::AffineRotation {
+    const auto opencv_placement{affine_rotation::from_cv(rvec, tvec)};
+    // The OpenCV camera coordinate system has X right and Y up while we want
+    // them the opposite way around as in the glTF coordinate system. Rotate the
+    // coordinates by 180° around the Z axis.
+    return affine_rotation::AffineRotation{
+               Eigen::Quaternionf{0.0F, 0.0F, 0.0F, 1.0F},
+               Eigen::Vector3f::Zero()} *
+           opencv_placement;
+}
+
+/// Merge overlapping rectangles until none of them overlap.
+void merge_overlapping(std::vector<cv::Rect> &rects) {
+    bool merged{true};
+    while (merged) {
+        merged = false;
+        for (std::size_t i{0}; i < rects.size(); ++i) {
+            std::size_t j{i + 1};
+            while (j < rects.size()) {
+                if ((rects[i] & rects[j]).empty()) {
+                    ++j;
+                    continue;
+                }
+                rects[i] |= rects[j];
+                rects[j] = rects.back();
+                rects.pop_back();
+                merged = true;
+            }
+        }
+    }
+}
+
+/// Append the object points of the markers in @p matches to @p object_points
+/// and the corresponding detected corners to @p image_points. The object
+/// points of the board's markers start at index @p first_marker of @p
+/// marker_points, and @p corners holds four corners for each detection.
+void append_matches(const std::vector<std::vector<cv::Point3f>> &marker_points,
+                    std::size_t first_marker,
+                    const std::vector<MarkerMatch> &matches,
+                    gsl::span<const cv::Point2f> corners,
+                    std::vector<cv::Point3f> &object_points,
+                    std::vector<cv::Point2f> &image_points) {
+    for (const auto &match : matches) {
+        const auto &marker{marker_points[first_marker + match.marker]};
+        const auto detected{corners.subspan(match.detection * 4, 4)};
+        object_points.insert(object_points.end(), marker.cbegin(),
+                             marker.cend());
+        image_points.insert(image_points.end(), detected.begin(),
+                            detected.end());
+    }
+}
+
+/// Return the diagonal of the bounding box of @p board relative to the side
+/// length of its smallest marker.
+auto relative_extent(const board::Board &board) -> float {
+    cv::Point3f min_corner{std::numeric_limits<float>::infinity(),
+                           std::numeric_limits<float>::infinity(),
+                           std::numeric_limits<float>::infinity()};
+    cv::Point3f max_corner{-std::numeric_limits<float>::infinity(),
+                           -std::numeric_limits<float>::infinity(),
+                           -std::numeric_limits<float>::infinity()};
+    float smallest_side{std::numeric_limits<float>::infinity()};
+    for (const auto &marker : board.obj_points) {
+        for (std::size_t i{0}; i < marker.size(); ++i) {
+            const auto &point{marker[i]};
+            min_corner = {std::min(min_corner.x, point.x),
+                          std::min(min_corner.y, point.y),
+                          std::min(min_corner.z, point.z)};
+            max_corner = {std::max(max_corner.x, point.x),
+                          std::max(max_corner.y, point.y),
+                          std::max(max_corner.z, point.z)};
+            smallest_side = std::min(
+                smallest_side,
+                static_cast<float>(cv::norm(marker[(i + 1) % marker.size()] -
+                                            point)));
+        }
+    }
+    if (board.obj_points.empty() || smallest_side <= 0.0F) {
+        return 0.0F;
+    }
+    return static_cast<float>(cv::norm(max_corner - min_corner)) /
+           smallest_side;
+}
+
+/// Empty @p markers, keeping their point buffers in @p spares for reuse.
+void recycle(std::vector<std::vector<cv::Point2f>> &markers,
+             std::vector<std::vector<cv::Point2f>> &spares) {
+    std::move(markers.begin(), markers.end(), std::back_inserter(spares));
+    markers.clear();
+}
+
+/// Append a copy of @p marker to @p markers, in a point buffer from @p spares
+/// if there is one left.
+void append_copy(const std::vector<cv::Point2f> &marker,
+                 std::vector<std::vector<cv::Point2f>> &markers,
+                 std::vector<std::vector<cv::Point2f>> &spares) {
+    if (spares.empty()) {
+        markers.push_back(marker);
+        return;
+    }
+    auto &copy{markers.emplace_back(std::move(spares.back()))};
+    spares.pop_back();
+    copy.assign(marker.cbegin(), marker.cend());
+}
+
+void translate(std::vector<cv::Point2f> &points, cv::Point2f offset) {
+    for (auto &point : points) {
+        point += offset;
+    }
+}
+
+/// Map @p points from a downscaled image to the original image, where one
+/// downscaled pixel covers @p scale original pixels.
+void upscale(std::vector<cv::Point2f> &points, cv::Point2f scale) {
+    for (auto &point : points) {
+        point = {((point.x + 0.5F) * scale.x) - 0.5F,
+                 ((point.y + 0.5F) * scale.y) - 0.5F};
+    }
+}
 
 } // namespace
 
@@ -44,145 +179,670 @@ void from_json(const nlohmann::json &j, BoardPlacement &placement) {
     const auto placement_vector{j.get<std::vector<PlacementJson>>()};
 
     placement = {};
-    placement.reserve(placement_vector.size());
     for (const auto &board : placement_vector) {
+        // The placements are stored in an array indexed by the ID.
+        if (board.id >= max_board_count) {
+            throw std::invalid_argument{"Board ID " + std::to_string(board.id) +
+                                        " is out of range"};
+        }
         placement.emplace(board.id, board.board_to_world);
     }
 }
 
+void to_json(nlohmann::json &j, const BoardPlacement &placement) {
+    std::vector<PlacementJson> placement_vector{};
+    placement_vector.reserve(placement.size());
+    for (const auto &[id, board_to_world] : placement) {
+        placement_vector.push_back({id, board_to_world});
+    }
+    j = placement_vector;
+}
+
+void to_json(nlohmann::json &j, const UncertainPlacement &placement) {
+    j = nlohmann::json::array();
+    for (const auto &[id, pose] : placement) {
+        j.push_back({{"id", id},
+                     {"board_to_world", pose.placement},
+                     {"reprojection_error", pose.reprojection_error}});
+    }
+}
+
+WorldModel::WorldModel(const cv::aruco::Dictionary &dictionary)
+    : dictionary_{&dictionary},
+      static_environment_{cv::Mat(0, 0, CV_32FC3), dictionary, {}},
+      marker_index_{static_cast<std::size_t>(dictionary.bytesList.rows)} {}
+
+auto WorldModel::addBoard(const board::Board &board) -> BoardId {
+    const auto id{static_cast<BoardId>(all_boards_.size())};
+    // Do this first: it throws if the board's markers clash with existing ones.
+    marker_index_.addBoard(id, board.marker_ids);
+    all_boards_.push_back(board::to_cv(*dictionary_, board));
+    static_marker_offsets_.emplace_back();
+    board_extents_.push_back(relative_extent(board));
+    return id;
+}
+
+void WorldModel::makeStatic(
+    BoardId id, const affine_rotation::AffineRotation &board_to_world) {
+    const std::array placements{std::pair{id, board_to_world}};
+    makeStatic(placements);
+}
+
+void WorldModel::makeStatic(
+    gsl::span<const std::pair<BoardId, affine_rotation::AffineRotation>>
+        placements) {
+    for (const auto &placement : placements) {
+        if (placement.first >= all_boards_.size()) {
+            throw std::invalid_argument{"No board with ID " +
+                                        std::to_string(placement.first)};
+        }
+    }
+
+    bool changed{false};
+    for (const auto &[id, board_to_world] : placements) {
+        if (static_board_placements_.emplace(id, board_to_world)) {
+            appendStaticBoard(id, board_to_world);
+            changed = true;
+        }
+    }
+    // cv::aruco::Board can't be extended, so it has to be recreated. Only do
+    // that once for all of the new boards.
+    if (changed) {
+        static_environment_ = {static_obj_points_, *dictionary_, static_ids_};
+    }
+}
+
+void WorldModel::appendStaticBoard(
+    BoardId id, const affine_rotation::AffineRotation &board_to_world) {
+    const auto &board{all_boards_[id]};
+    static_marker_offsets_[id] = static_obj_points_.size();
+
+    static_obj_points_.reserve(static_obj_points_.size() +
+                               board.getObjPoints().size());
+    for (const auto &points : board.getObjPoints()) {
+        board_to_world.transform(
+            points, static_obj_points_.emplace_back(points.size()));
+    }
+
+    static_ids_.insert(static_ids_.end(), board.getIds().cbegin(),
+                       board.getIds().cend());
+}
+
 World::World(cv::Mat camera_matrix, cv::Mat distortion_coeffs,
-             const cv::aruco::Dictionary &dictionary)
+             const cv::aruco::Dictionary &dictionary,
+             const detector_config::DetectorConfig &config)
     : camera_matrix_{std::move(camera_matrix)},
       distortion_coeffs_{std::move(distortion_coeffs)},
-      dictionary_{&dictionary}, detector_{dictionary, {}},
-      static_environment_{cv::Mat(0, 0, CV_32FC3), dictionary, {}} {}
+      own_model_{std::make_shared<WorldModel>(dictionary)},
+      model_{own_model_},
+      detector_{dictionary, config.detector, config.refine},
+      has_distortion_{!distortion_coeffs_.empty() &&
+                      cv::countNonZero(distortion_coeffs_) > 0} {}
+
+World::World(gsl::not_null<std::shared_ptr<const WorldModel>> model,
+             cv::Mat camera_matrix, cv::Mat distortion_coeffs,
+             const detector_config::DetectorConfig &config)
+    : camera_matrix_{std::move(camera_matrix)},
+      distortion_coeffs_{std::move(distortion_coeffs)}, model_{model.get()},
+      detector_{model_->dictionary(), config.detector, config.refine},
+      has_distortion_{!distortion_coeffs_.empty() &&
+                      cv::countNonZero(distortion_coeffs_) > 0} {}
 
 auto World::addBoard(const board::Board &board) -> BoardId {
-    all_boards_.push_back(board::to_cv(*dictionary_, board));
-    return static_cast<std::uint32_t>(all_boards_.size()) - 1;
+    Expects(own_model_);
+    return own_model_->addBoard(board);
 }
 
 void World::makeStatic(BoardId id,
                        const affine_rotation::AffineRotation &board_to_world) {
-    Expects(id < all_boards_.size());
-    static_board_placements_.emplace(id, board_to_world);
-    // TODO(vainiovano): Avoid regenerating the environment from scratch every
-    // time?
-    recomputeStaticEnvironment();
-}
-
-auto World::fit(const cv::Mat &image) const -> FitResult {
-    std::vector<std::vector<cv::Point2f>> corners{};
-    std::vector<std::vector<cv::Point2f>> rejected{};
-    std::vector<int> ids{};
-    detector_.detectMarkers(image, corners, ids, rejected);
-    detector_.refineDetectedMarkers(image, static_environment_, corners, ids,
-                                    rejected, camera_matrix_,
-                                    distortion_coeffs_);
-    for (BoardId board_id{0}; board_id < all_boards_.size(); ++board_id) {
-        if (static_board_placements_.find(board_id) !=
-            static_board_placements_.cend()) {
-            continue;
+    Expects(own_model_);
+    own_model_->makeStatic(id, board_to_world);
+}
+
+void World::makeStatic(
+    gsl::span<const std::pair<BoardId, affine_rotation::AffineRotation>>
+        placements) {
+    Expects(own_model_);
+    own_model_->makeStatic(placements);
+}
+
+void World::enableTracking(const TrackingParameters &parameters) {
+    Expects(parameters.full_scan_period > 0);
+    tracking_ = parameters;
+}
+
+void World::enablePyramid(const PyramidParameters &parameters) {
+    Expects(parameters.min_marker_side > 0.0F);
+    Expects(parameters.max_level >= 0);
+    pyramid_ = parameters;
+}
+
+auto World::fit(const cv::Mat &image) -> FitResult {
+    FitWorkspace workspace{};
+    FitResult result{};
+    fit(image, workspace, result);
+    return result;
+}
+
+void World::fit(const cv::Mat &image, FitWorkspace &workspace,
+                FitResult &result) {
+    fit(image,
+        image.channels() == 1 ? pixel_format::PixelFormat::gray
+                              : pixel_format::PixelFormat::bgr,
+        workspace, result);
+}
+
+void World::fit(const cv::Mat &frame, pixel_format::PixelFormat format,
+                FitWorkspace &workspace, FitResult &result) {
+    fit(frame, format, std::chrono::steady_clock::now(), workspace, result);
+}
+
+void World::fit(const cv::Mat &frame, pixel_format::PixelFormat format,
+                std::chrono::steady_clock::time_point capture_time,
+                FitWorkspace &workspace, FitResult &result) {
+    const auto total_timer{profile_.time(profiling::Stage::total)};
+    const auto &model{*model_};
+    if (board_tracks_.size() < model.boardCount()) {
+        board_tracks_.resize(model.boardCount());
+    }
+    // Convert the frame only once here, since the detector and each refinement
+    // pass would otherwise convert colour images into greyscale on their own.
+    const cv::Mat image{pixel_format::luma(frame, format, workspace.grey)};
+    auto &corners{result.corners};
+    auto &ids{result.ids};
+    auto &rejected{workspace.rejected};
+    recycle(corners, workspace.spare_points);
+    ids.clear();
+    recycle(rejected, workspace.spare_points);
+    result.camera_to_world.reset();
+    result.dynamic_board_placements.clear();
+    result.capture_time = capture_time;
+
+    bool full_scan{!tracking_ || track_lost_ ||
+                   frames_since_full_scan_ >= tracking_->full_scan_period};
+    auto &regions{workspace.regions};
+    regions.clear();
+    if (!full_scan) {
+        predictRegions(image.size(), workspace);
+        const auto covered_area{std::accumulate(
+            regions.cbegin(), regions.cend(), 0.0,
+            [](double area, const cv::Rect &region) {
+                return area + region.area();
+            })};
+        full_scan = regions.empty() ||
+                    covered_area > tracking_->max_coverage *
+                                       static_cast<double>(image.size().area());
+    }
+    {
+        const auto timer{profile_.time(profiling::Stage::detect)};
+        if (full_scan) {
+            detectInRegion(image, {{0, 0}, image.size()}, workspace, corners,
+                           ids);
+            frames_since_full_scan_ = 0;
+        } else {
+            for (const auto &region : regions) {
+                detectInRegion(image, region, workspace, corners, ids);
+            }
+            ++frames_since_full_scan_;
         }
-        detector_.refineDetectedMarkers(image, all_boards_[board_id], corners,
-                                        ids, rejected, camera_matrix_,
+    }
+    if (pyramid_level_ > 0) {
+        const auto timer{profile_.time(profiling::Stage::refine_corners)};
+        refineCorners(image, workspace, corners);
+    }
+
+    // Without a static environment, there's nothing to recover markers of.
+    if (!model.staticEnvironment().getIds().empty()) {
+        const auto timer{profile_.time(profiling::Stage::refine_static)};
+        detector_.refineDetectedMarkers(image, model.staticEnvironment(),
+                                        corners, ids, rejected, camera_matrix_,
                                         distortion_coeffs_);
     }
 
-    std::optional<UncertainPose> camera_to_world{};
-    UncertainPlacement dynamic_board_placements{};
-    const auto static_environment_fit{
-        fitBoard(corners, ids, static_environment_)};
-    if (static_environment_fit) {
-        camera_to_world = {static_environment_fit->reprojection_error,
-                           static_environment_fit->placement.inverse()};
+    auto &buckets{workspace.buckets};
+    {
+        const auto timer{profile_.time(profiling::Stage::match)};
+        model.markerIndex().partition(ids, buckets);
+    }
+    bool refined{false};
+    {
+        const auto timer{profile_.time(profiling::Stage::refine_dynamic)};
+        refined = refineDynamicBoards(image, workspace, corners, ids);
+    }
+    if (refined) {
+        const auto timer{profile_.time(profiling::Stage::match)};
+        model.markerIndex().partition(ids, buckets);
+    }
+
+    // A board that was tracked into this frame but can't be found anymore has
+    // probably moved out of the predicted regions.
+    bool track_lost{false};
+    const auto update_track = [&track_lost](
+                                  std::optional<PnpSolution> &track,
+                                  const std::optional<PnpSolution> &solution) {
+        track_lost = track_lost || (track && !solution);
+        track = solution;
+    };
+
+    const auto &pinhole_corners{
+        [this, &corners, &workspace]() -> const std::vector<cv::Point2f> & {
+            const auto timer{profile_.time(profiling::Stage::undistort)};
+            return undistortCorners(corners, workspace);
+        }()};
+    auto &object_points{workspace.object_points};
+    auto &image_points{workspace.image_points};
+    object_points.clear();
+    image_points.clear();
+    for (const auto board_id : buckets.boards) {
+        const auto &static_offset{model.staticMarkerOffset(board_id)};
+        if (static_offset) {
+            append_matches(model.staticEnvironment().getObjPoints(),
+                           *static_offset,
+                           buckets.matches[board_id], pinhole_corners,
+                           object_points, image_points);
+        }
+    }
+
+    auto &camera_to_world{result.camera_to_world};
+    {
+        const auto timer{profile_.time(profiling::Stage::solve_static)};
+        update_track(static_environment_track_,
+                     solvePose(object_points, image_points,
+                               static_environment_track_, workspace));
+    }
+    if (static_environment_track_) {
+        camera_to_world = {
+            static_environment_track_->reprojection_error,
+            to_gltf(static_environment_track_->rvec,
+                    static_environment_track_->tvec)
+                .inverse()};
         // Help clang-tidy 18's bugprone-unchecked-optional-access lint. Newer
         // versions are smarter.
         const auto &camera_to_world_placement{camera_to_world->placement};
+        const auto timer{profile_.time(profiling::Stage::solve_dynamic)};
         // TODO(vainiovano): Allow producing results even if the exact camera
         // location is not known.
-        for (BoardId board_id{0}; board_id < all_boards_.size(); ++board_id) {
-            if (static_board_placements_.find(board_id) !=
-                static_board_placements_.cend()) {
+
+        // Only the boards with matched markers can be found. The other boards
+        // tracked in the previous frame are lost.
+        for (const auto board_id : tracked_boards_) {
+            if (model.staticMarkerOffset(board_id) ||
+                buckets.matches[board_id].empty()) {
+                update_track(board_tracks_[board_id], std::nullopt);
+            }
+        }
+        tracked_boards_.clear();
+        for (const auto board_id : buckets.boards) {
+            if (model.staticMarkerOffset(board_id)) {
                 continue;
             }
-            const auto board_to_camera{
-                fitBoard(corners, ids, all_boards_[board_id])};
-            if (board_to_camera) {
+
+            auto &track{board_tracks_[board_id]};
+            const auto &matches{buckets.matches[board_id]};
+            const auto board_timer{profile_.timeBoard(board_id)};
+            object_points.clear();
+            image_points.clear();
+            append_matches(model.board(board_id).getObjPoints(), 0, matches,
+                           pinhole_corners, object_points, image_points);
+            update_track(track, solvePose(object_points, image_points, track,
+                                          workspace));
+            if (track) {
+                tracked_boards_.push_back(board_id);
                 // TODO(vainiovano): Combine the reprojection error with that of
                 // the camera location?
-                dynamic_board_placements.emplace(
-                    board_id, UncertainPose{board_to_camera->reprojection_error,
-                                            camera_to_world_placement *
-                                                board_to_camera->placement});
+                result.dynamic_board_placements.emplace(
+                    board_id,
+                    UncertainPose{track->reprojection_error,
+                                  camera_to_world_placement *
+                                      to_gltf(track->rvec, track->tvec)});
             }
         }
+    } else {
+        for (const auto board_id : tracked_boards_) {
+            update_track(board_tracks_[board_id], std::nullopt);
+        }
+        tracked_boards_.clear();
+    }
+    // Boards lost during a full scan are really gone, so there's no point in
+    // scanning again right away.
+    track_lost_ = track_lost && !full_scan;
+    updatePyramidLevel(corners);
+}
+
+auto World::refineDynamicBoards(const cv::Mat &image, FitWorkspace &workspace,
+                                std::vector<std::vector<cv::Point2f>> &corners,
+                                std::vector<int> &ids) const -> bool {
+    const auto &buckets{workspace.buckets};
+    const auto &rejected{workspace.rejected};
+    if (rejected.empty()) {
+        return false;
+    }
+
+    const auto detected_count{ids.size()};
+    auto &nearby_candidates{workspace.nearby_candidates};
+    for (const auto board_id : buckets.boards) {
+        const auto &board{model_->board(board_id)};
+        const auto &matches{buckets.matches[board_id]};
+        // Refinement needs some detected markers for estimating the board
+        // pose, and there's nothing to refine if all markers were detected.
+        if (model_->staticMarkerOffset(board_id) ||
+            matches.size() >= board.getIds().size()) {
+            continue;
+        }
+
+        const auto region{searchRegion(board_id, matches, corners)};
+        recycle(nearby_candidates, workspace.spare_points);
+        for (const auto &candidate : rejected) {
+            if (std::all_of(candidate.cbegin(), candidate.cend(),
+                            [&region](cv::Point2f point) {
+                                return region.contains(point);
+                            })) {
+                append_copy(candidate, nearby_candidates,
+                            workspace.spare_points);
+            }
+        }
+        if (nearby_candidates.empty()) {
+            continue;
+        }
+        // NOTE: The candidates used here aren't removed from rejected, but
+        // since each marker ID belongs to a single board, no other board can
+        // claim them.
+        detector_.refineDetectedMarkers(image, board, corners, ids,
+                                        nearby_candidates, camera_matrix_,
+                                        distortion_coeffs_);
     }
+    return ids.size() != detected_count;
+}
 
-    return {std::move(corners), std::move(ids), std::move(camera_to_world),
-            std::move(dynamic_board_placements)};
+auto World::searchRegion(BoardId board_id,
+                         const std::vector<MarkerMatch> &matches,
+                         const std::vector<std::vector<cv::Point2f>> &corners)
+    const -> cv::Rect2f {
+    Expects(!matches.empty());
+
+    cv::Point2f min_corner{std::numeric_limits<float>::infinity(),
+                           std::numeric_limits<float>::infinity()};
+    cv::Point2f max_corner{-std::numeric_limits<float>::infinity(),
+                           -std::numeric_limits<float>::infinity()};
+    float largest_side{0.0F};
+    for (const auto &match : matches) {
+        const auto &marker{corners[match.detection]};
+        for (std::size_t i{0}; i < marker.size(); ++i) {
+            min_corner = {std::min(min_corner.x, marker[i].x),
+                          std::min(min_corner.y, marker[i].y)};
+            max_corner = {std::max(max_corner.x, marker[i].x),
+                          std::max(max_corner.y, marker[i].y)};
+            const auto side{marker[(i + 1) % marker.size()] - marker[i]};
+            largest_side = std::max(
+                largest_side, static_cast<float>(std::hypot(side.x, side.y)));
+        }
+    }
+
+    // The rest of the board can't be further away from the detected markers
+    // than the size of the whole board.
+    const float padding{model_->boardExtent(board_id) * largest_side};
+    return {min_corner - cv::Point2f{padding, padding},
+            max_corner + cv::Point2f{padding, padding}};
 }
 
-auto World::fitBoard(const std::vector<std::vector<cv::Point2f>> &corners,
-                     const std::vector<int> &ids, const cv::aruco::Board &board)
-    const -> std::optional<UncertainPose> {
-    if (ids.empty()) {
+auto World::solvePose(const std::vector<cv::Point3f> &object_points,
+                      const std::vector<cv::Point2f> &image_points,
+                      const std::optional<PnpSolution> &previous,
+                      FitWorkspace &workspace) const
+    -> std::optional<PnpSolution> {
+    Expects(object_points.size() == image_points.size());
+    if (object_points.size() / 4 <
+        static_cast<std::size_t>(min_marker_count)) {
         return {};
     }
 
-    cv::Mat object_points;
-    cv::Mat image_points;
-    board.matchImagePoints(corners, ids, object_points, image_points);
-    if (object_points.rows / 4 < min_marker_count) {
-        return {};
+    auto &rvecs{workspace.rvecs};
+    auto &tvecs{workspace.tvecs};
+    auto &reprojection_errors{workspace.reprojection_errors};
+    std::optional<PnpSolution> warm_solution{};
+    if (previous) {
+        // Starting from the previous pose converges in fewer iterations and
+        // keeps the solver from jumping between ambiguous poses.
+        cv::Vec3f rvec{previous->rvec};
+        cv::Vec3f tvec{previous->tvec};
+        const auto num_solutions{cv::solvePnPGeneric(
+            object_points, image_points, camera_matrix_, cv::noArray(), rvecs,
+            tvecs, true, cv::SOLVEPNP_ITERATIVE, rvec, tvec,
+            reprojection_errors)};
+        if (num_solutions > 0) {
+            warm_solution = {reprojection_errors[0], rvecs[0], tvecs[0]};
+            if (warm_solution->reprojection_error <= max_warm_start_error &&
+                warm_solution->tvec[2] > 0.0F) {
+                return warm_solution;
+            }
+        }
     }
 
-    std::vector<cv::Vec3f> rvecs;
-    std::vector<cv::Vec3f> tvecs;
-    std::vector<float> reprojection_errors;
+    // The board moved too far for the previous pose to be useful, so solve
+    // from scratch.
     const auto num_solutions{cv::solvePnPGeneric(
-        object_points, image_points, camera_matrix_, distortion_coeffs_, rvecs,
+        object_points, image_points, camera_matrix_, cv::noArray(), rvecs,
         tvecs, false, cv::SOLVEPNP_ITERATIVE, cv::noArray(), cv::noArray(),
         reprojection_errors)};
     if (num_solutions == 0) {
-        return {};
+        return warm_solution;
+    }
+    if (warm_solution &&
+        warm_solution->reprojection_error < reprojection_errors[0]) {
+        return warm_solution;
     }
 
-    const auto opencv_placement{affine_rotation::from_cv(rvecs[0], tvecs[0])};
-    // The OpenCV camera coordinate system has X right and Y up while we want
-    // them the opposite way around as in the glTF coordinate system. Rotate the
-    // coordinates by 180° around the Z axis.
-    const auto gltf_placement{affine_rotation::AffineRotation{
-                                  Eigen::Quaternionf{0.0F, 0.0F, 0.0F, 1.0F},
-                                  Eigen::Vector3f::Zero()} *
-                              opencv_placement};
-    return {{reprojection_errors[0], gltf_placement}};
-}
-
-void World::recomputeStaticEnvironment() {
-    std::vector<std::vector<cv::Point3f>> obj_points{};
-    std::vector<int> ids{};
-
-    for (const auto &[id, placement] : static_board_placements_) {
-        const auto board{all_boards_[id]};
-        const auto &board_to_world{placement};
-
-        obj_points.reserve(obj_points.size() + board.getObjPoints().size());
-        std::transform(
-            board.getObjPoints().cbegin(), board.getObjPoints().cend(),
-            std::back_inserter(obj_points),
-            [&board_to_world](const std::vector<cv::Point3f> &points) {
-                std::vector<cv::Point3f> res(4);
-                std::transform(points.cbegin(), points.cend(), res.begin(),
-                               [&board_to_world](cv::Point3f point) {
-                                   return board_to_world * point;
-                               });
-                return res;
-            });
-
-        ids.insert(ids.end(), board.getIds().cbegin(), board.getIds().cend());
-    }
-    static_environment_ = {obj_points, *dictionary_, ids};
+    return {{reprojection_errors[0], rvecs[0], tvecs[0]}};
+}
+
+void World::predictRegions(cv::Size image_size,
+                           FitWorkspace &workspace) const {
+    workspace.regions.clear();
+    if (static_environment_track_) {
+        predictBoardRegions(model_->staticEnvironment(),
+                            *static_environment_track_, image_size, workspace);
+    }
+    for (const auto board_id : tracked_boards_) {
+        predictBoardRegions(model_->board(board_id), *board_tracks_[board_id],
+                            image_size, workspace);
+    }
+    merge_overlapping(workspace.regions);
+}
+
+void World::predictBoardRegions(const cv::aruco::Board &board,
+                                const PnpSolution &board_to_camera,
+                                cv::Size image_size,
+                                FitWorkspace &workspace) const {
+    Expects(tracking_);
+
+    auto &regions{workspace.regions};
+    auto &object_points{workspace.object_points};
+    object_points.clear();
+    for (const auto &marker : board.getObjPoints()) {
+        object_points.insert(object_points.end(), marker.cbegin(),
+                             marker.cend());
+    }
+    if (object_points.empty()) {
+        return;
+    }
+
+    auto &image_points{workspace.image_points};
+    cv::projectPoints(object_points, board_to_camera.rvec,
+                      board_to_camera.tvec, camera_matrix_, distortion_coeffs_,
+                      image_points);
+
+    cv::Matx33f rotation{};
+    cv::Rodrigues(board_to_camera.rvec, rotation);
+    const cv::Rect image_rect{{0, 0}, image_size};
+    // The image edge can clip a region down to a sliver that can't hold a
+    // whole marker. On a downscaled level, a region smaller than the smallest
+    // marker that level is chosen for could even shrink to nothing.
+    const int min_region_side{
+        pyramid_level_ > 0
+            ? static_cast<int>(std::ceil(pyramid_->min_marker_side))
+                  << pyramid_level_
+            : 1};
+    for (std::size_t corner{0}; corner + 4 <= object_points.size();
+         corner += 4) {
+        // Projections of points behind the camera are meaningless.
+        const bool in_front{std::all_of(
+            object_points.cbegin() + static_cast<std::ptrdiff_t>(corner),
+            object_points.cbegin() + static_cast<std::ptrdiff_t>(corner + 4),
+            [&rotation, &board_to_camera](const cv::Point3f &point) {
+                return (rotation * cv::Vec3f{point.x, point.y, point.z})[2] +
+                           board_to_camera.tvec[2] >
+                       0.0F;
+            })};
+        if (!in_front) {
+            continue;
+        }
+
+        const auto [min_x, max_x] = std::minmax(
+            {image_points[corner].x, image_points[corner + 1].x,
+             image_points[corner + 2].x, image_points[corner + 3].x});
+        const auto [min_y, max_y] = std::minmax(
+            {image_points[corner].y, image_points[corner + 1].y,
+             image_points[corner + 2].y, image_points[corner + 3].y});
+        const float padding{
+            std::max(static_cast<float>(tracking_->min_padding),
+                     tracking_->relative_padding *
+                         std::max(max_x - min_x, max_y - min_y))};
+        const cv::Rect region{
+            cv::Point{static_cast<int>(std::floor(min_x - padding)),
+                      static_cast<int>(std::floor(min_y - padding))},
+            cv::Point{static_cast<int>(std::ceil(max_x + padding)),
+                      static_cast<int>(std::ceil(max_y + padding))}};
+        const cv::Rect clipped_region{region & image_rect};
+        if (clipped_region.width >= min_region_side &&
+            clipped_region.height >= min_region_side) {
+            regions.push_back(clipped_region);
+        }
+    }
+}
+
+void World::detectInRegion(const cv::Mat &image, cv::Rect region,
+                           FitWorkspace &workspace,
+                           std::vector<std::vector<cv::Point2f>> &corners,
+                           std::vector<int> &ids) const {
+    auto &region_corners{workspace.region_corners};
+    auto &region_rejected{workspace.region_rejected};
+    auto &region_ids{workspace.region_ids};
+    const cv::Mat region_image{image(region)};
+    // Tiny images would downscale to nothing, so detect on them as they are.
+    const int min_downscaled_side{1 << pyramid_level_};
+    if (pyramid_level_ == 0 || region.width < min_downscaled_side ||
+        region.height < min_downscaled_side) {
+        detector_.detectMarkers(region_image, region_corners, region_ids,
+                                region_rejected);
+    } else {
+        const double factor{1.0 / static_cast<double>(1 << pyramid_level_)};
+        auto &downscaled{workspace.downscaled};
+        cv::resize(region_image, downscaled, {}, factor, factor,
+                   cv::INTER_AREA);
+        detector_.detectMarkers(downscaled, region_corners, region_ids,
+                                region_rejected);
+
+        // Map pixel centers rather than pixel corners onto each other.
+        const cv::Point2f scale{
+            static_cast<float>(region_image.cols) /
+                static_cast<float>(downscaled.cols),
+            static_cast<float>(region_image.rows) /
+                static_cast<float>(downscaled.rows)};
+        for (auto &marker : region_corners) {
+            upscale(marker, scale);
+        }
+        for (auto &candidate : region_rejected) {
+            upscale(candidate, scale);
+        }
+    }
+
+    const cv::Point2f offset{static_cast<float>(region.x),
+                             static_cast<float>(region.y)};
+    for (auto &marker : region_corners) {
+        translate(marker, offset);
+    }
+    for (auto &candidate : region_rejected) {
+        translate(candidate, offset);
+    }
+    // Copy the points rather than moving the buffers out, so that the
+    // detector can write the next region's points into the same buffers.
+    for (const auto &marker : region_corners) {
+        append_copy(marker, corners, workspace.spare_points);
+    }
+    for (const auto &candidate : region_rejected) {
+        append_copy(candidate, workspace.rejected, workspace.spare_points);
+    }
+    ids.insert(ids.end(), region_ids.cbegin(), region_ids.cend());
+}
+
+void World::refineCorners(
+    const cv::Mat &image, FitWorkspace &workspace,
+    std::vector<std::vector<cv::Point2f>> &corners) const {
+    if (corners.empty()) {
+        return;
+    }
+
+    auto &points{workspace.corner_points};
+    points.clear();
+    for (const auto &marker : corners) {
+        points.insert(points.end(), marker.cbegin(), marker.cend());
+    }
+    // The corners can be off by about one downscaled pixel in each direction.
+    const int window_half_side{std::max(2, 1 << pyramid_level_)};
+    cv::cornerSubPix(
+        image, points, {window_half_side, window_half_side}, {-1, -1},
+        {cv::TermCriteria::COUNT | cv::TermCriteria::EPS, 30, 0.01});
+
+    auto point{points.cbegin()};
+    for (auto &marker : corners) {
+        for (auto &corner : marker) {
+            corner = *point++;
+        }
+    }
+}
+
+auto World::undistortCorners(
+    const std::vector<std::vector<cv::Point2f>> &corners,
+    FitWorkspace &workspace) const -> const std::vector<cv::Point2f> & {
+    auto &points{workspace.corner_points};
+    points.clear();
+    for (const auto &marker : corners) {
+        points.insert(points.end(), marker.cbegin(), marker.cend());
+    }
+    if (!has_distortion_ || points.empty()) {
+        return points;
+    }
+
+    // Keep the points in pixel coordinates by projecting them back with the
+    // same camera matrix, just without the distortion.
+    auto &undistorted{workspace.undistorted_corners};
+    cv::undistortPoints(
+        points, undistorted, camera_matrix_, distortion_coeffs_, cv::noArray(),
+        camera_matrix_,
+        {cv::TermCriteria::COUNT | cv::TermCriteria::EPS, 10, 0.01});
+    return undistorted;
+}
+
+void World::updatePyramidLevel(
+    const std::vector<std::vector<cv::Point2f>> &corners) {
+    pyramid_level_ = 0;
+    if (!pyramid_ || corners.empty()) {
+        return;
+    }
+
+    float smallest_side{std::numeric_limits<float>::infinity()};
+    for (const auto &marker : corners) {
+        for (std::size_t i{0}; i < marker.size(); ++i) {
+            const auto side{marker[(i + 1) % marker.size()] - marker[i]};
+            smallest_side = std::min(
+                smallest_side, static_cast<float>(std::hypot(side.x, side.y)));
+        }
+    }
+    while (pyramid_level_ < pyramid_->max_level &&
+           smallest_side / static_cast<float>(2 << pyramid_level_) >=
+               pyramid_->min_marker_side) {
+        ++pyramid_level_;
+    }
 }
 
 } // namespace bananas::world
@@ -0,0 +1,55 @@
+#include <cstddef>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <opencv2/core/types.hpp>
+
+#include <bananas_aruco/affine_rotation.h>
+
+// LINT: gtest macros quickly bump this metric up.
+// NOLINTBEGIN(readability-function-cognitive-complexity)
+
+namespace {
+
+namespace affine_rotation = bananas::affine_rotation;
+
+constexpr float error_bound{1E-5};
+
+} // namespace
+
+TEST(AffineRotationTest, TransformMatchesPointwiseProduct) {
+    const affine_rotation::AffineRotation transform{
+        Eigen::Quaternionf{
+            Eigen::AngleAxisf{0.7F, Eigen::Vector3f{1.0F, 2.0F, -0.5F}
+                                        .normalized()}},
+        {0.1F, -2.0F, 3.5F}};
+    std::vector<cv::Point3f> points{};
+    for (int i{0}; i < 37; ++i) {
+        const auto x{static_cast<float>(i)};
+        points.emplace_back(x, -0.5F * x, 1.0F + (0.25F * x));
+    }
+
+    std::vector<cv::Point3f> transformed(points.size());
+    transform.transform(points, transformed);
+
+    for (std::size_t i{0}; i < points.size(); ++i) {
+        const auto expected{transform * points[i]};
+        EXPECT_NEAR(transformed[i].x, expected.x, error_bound) << i;
+        EXPECT_NEAR(transformed[i].y, expected.y, error_bound) << i;
+        EXPECT_NEAR(transformed[i].z, expected.z, error_bound) << i;
+    }
+}
+
+TEST(AffineRotationTest, TransformAcceptsEmptySpans) {
+    const affine_rotation::AffineRotation transform{};
+    const std::vector<cv::Point3f> points{};
+    std::vector<cv::Point3f> transformed{};
+    transform.transform(points, transformed);
+    EXPECT_TRUE(transformed.empty());
+}
+
+// NOLINTEND(readability-function-cognitive-complexity)
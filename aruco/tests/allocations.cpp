@@ -0,0 +1,217 @@
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
+#include <opencv2/core/utility.hpp>
+#include <opencv2/objdetect/aruco_detector.hpp>
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/board.h>
+#include <bananas_aruco/detector_config.h>
+#include <bananas_aruco/grid_board.h>
+#include <bananas_aruco/marker_index.h>
+#include <bananas_aruco/pixel_format.h>
+#include <bananas_aruco/renderer.h>
+#include <bananas_aruco/world.h>
+
+// LINT: gtest macros quickly bump this metric up.
+// NOLINTBEGIN(readability-function-cognitive-complexity)
+
+namespace {
+
+namespace affine_rotation = bananas::affine_rotation;
+namespace board = bananas::board;
+namespace detector_config = bananas::detector_config;
+namespace pixel_format = bananas::pixel_format;
+namespace renderer = bananas::renderer;
+namespace world = bananas::world;
+
+constexpr float pi{3.1415927F};
+
+auto make_camera_matrix() -> cv::Mat {
+    return (cv::Mat_<double>(3, 3) << 900.0, 0.0, 640.0, 0.0, 900.0, 360.0,
+            0.0, 0.0, 1.0);
+}
+
+auto make_grid() -> board::Board {
+    return board::make_board(board::GridSettings{{3, 3}, 0.1F, 0.05F, 0});
+}
+
+/// Render @p grid 1.5 metres in front of the camera.
+auto render_grid(const cv::Mat &camera_matrix,
+                 const cv::aruco::Dictionary &dictionary,
+                 const board::Board &grid) -> cv::Mat {
+    const renderer::Renderer renderer{camera_matrix, cv::Mat{}, {1280, 720},
+                                      dictionary};
+    const std::array boards{renderer::BoardPose{
+        &grid, affine_rotation::AffineRotation{
+                   Eigen::Quaternionf{Eigen::AngleAxisf{
+                       -pi / 2.0F, Eigen::Vector3f::UnitX()}},
+                   {0.1F, -0.05F, 1.5F}}}};
+    cv::Mat image{};
+    renderer.render(boards, image);
+    return image;
+}
+
+std::atomic<std::size_t> allocation_count{0};
+
+/// Count the heap allocations made during the lifetime of this object.
+class AllocationCounter {
+  public:
+    AllocationCounter() : start_{allocation_count.load()} {}
+
+    [[nodiscard]] auto count() const -> std::size_t {
+        return allocation_count.load() - start_;
+    }
+
+  private:
+    std::size_t start_;
+};
+
+} // namespace
+
+// Replace the global allocation functions to count allocations. The other
+// forms of operator new and delete forward to these. Keep GCC from inlining
+// them, since it then complains about mixing malloc() and delete.
+[[gnu::noinline]] auto operator new(std::size_t size) -> void * {
+    ++allocation_count;
+    // NOLINTNEXTLINE(cppcoreguidelines-no-malloc)
+    if (void *pointer{std::malloc(size == 0 ? 1 : size)}) {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+[[gnu::noinline]] void operator delete(void *pointer) noexcept {
+    // NOLINTNEXTLINE(cppcoreguidelines-no-malloc)
+    std::free(pointer);
+}
+
+[[gnu::noinline]] void operator delete(void *pointer,
+                                       std::size_t /*size*/) noexcept {
+    // NOLINTNEXTLINE(cppcoreguidelines-no-malloc)
+    std::free(pointer);
+}
+
+TEST(AllocationTest, CounterSeesAllocations) {
+    const AllocationCounter counter{};
+    const std::vector<int> values(16);
+    ASSERT_NE(values.data(), nullptr);
+    EXPECT_EQ(counter.count(), std::size_t{1});
+}
+
+TEST(AllocationTest, PartitionReusesBuckets) {
+    world::MarkerIndex index{100};
+    index.addBoard(0, {3, 1, 4});
+    index.addBoard(1, {15, 9});
+    index.addBoard(2, {26, 5});
+
+    world::DetectionBuckets buckets{};
+    const std::vector<int> ids{4, 9, 99, 3, 1, 15};
+    const std::vector<int> other_ids{26, 1, 5};
+    index.partition(ids, buckets);
+    index.partition(other_ids, buckets);
+
+    const AllocationCounter counter{};
+    for (int frame{0}; frame < 10; ++frame) {
+        index.partition(ids, buckets);
+        index.partition(other_ids, buckets);
+    }
+    EXPECT_EQ(counter.count(), std::size_t{0});
+
+    ASSERT_EQ(buckets.boards.size(), std::size_t{2});
+    EXPECT_EQ(buckets.matches[2].size(), std::size_t{2});
+    EXPECT_EQ(buckets.matches[0].size(), std::size_t{1});
+    EXPECT_TRUE(buckets.matches[1].empty());
+}
+
+TEST(AllocationTest, FitReusesWorkspace) {
+    // OpenCV's worker threads would make the counts vary from run to run.
+    cv::setNumThreads(1);
+    const auto dictionary{
+        cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_100)};
+    const auto camera_matrix{make_camera_matrix()};
+    const auto grid{make_grid()};
+    const auto image{render_grid(camera_matrix, dictionary, grid)};
+
+    // Without a static environment there's no camera pose to solve for, so
+    // the detector is all that fit() runs of OpenCV.
+    world::World world{camera_matrix, cv::Mat{}, dictionary};
+    world.addBoard(grid);
+    world::FitWorkspace workspace{};
+    world::FitResult result{};
+    const auto fit = [&]() -> std::size_t {
+        const AllocationCounter counter{};
+        world.fit(image, pixel_format::PixelFormat::gray, workspace, result);
+        return counter.count();
+    };
+
+    const detector_config::DetectorConfig config{};
+    const cv::aruco::ArucoDetector detector{dictionary, config.detector,
+                                            config.refine};
+    std::vector<std::vector<cv::Point2f>> corners{};
+    std::vector<int> ids{};
+    std::vector<std::vector<cv::Point2f>> rejected{};
+    const auto detect = [&]() -> std::size_t {
+        const AllocationCounter counter{};
+        detector.detectMarkers(image, corners, ids, rejected);
+        return counter.count();
+    };
+
+    // The first frames size the buffers, including the spare point buffers
+    // that only fill up on the second frame. After that, fit() allocates only
+    // what the detector allocates internally.
+    static_cast<void>(fit());
+    static_cast<void>(fit());
+    static_cast<void>(detect());
+    ASSERT_EQ(result.ids.size(), std::size_t{9});
+    ASSERT_EQ(ids.size(), std::size_t{9});
+    const auto detector_count{detect()};
+    for (int frame{0}; frame < 5; ++frame) {
+        EXPECT_EQ(fit(), detector_count);
+    }
+    EXPECT_EQ(result.corners, corners);
+}
+
+TEST(AllocationTest, PoseSolvingAllocatesTheSameEveryFrame) {
+    cv::setNumThreads(1);
+    const auto dictionary{
+        cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_100)};
+    const auto camera_matrix{make_camera_matrix()};
+    const auto grid{make_grid()};
+    const auto image{render_grid(camera_matrix, dictionary, grid)};
+
+    world::World world{camera_matrix, cv::Mat{}, dictionary};
+    world.makeStatic(world.addBoard(grid), affine_rotation::AffineRotation{});
+    world::FitWorkspace workspace{};
+    world::FitResult result{};
+    const auto fit = [&]() -> std::size_t {
+        const AllocationCounter counter{};
+        world.fit(image, pixel_format::PixelFormat::gray, workspace, result);
+        return counter.count();
+    };
+
+    // OpenCV allocates while refining and solving, but the same amount for
+    // the same frame.
+    const auto first{fit()};
+    ASSERT_TRUE(result.camera_to_world.has_value());
+    const auto second{fit()};
+    EXPECT_LT(second, first);
+    for (int frame{0}; frame < 5; ++frame) {
+        EXPECT_EQ(fit(), second);
+    }
+    EXPECT_TRUE(result.camera_to_world.has_value());
+}
+
+// NOLINTEND(readability-function-cognitive-complexity)
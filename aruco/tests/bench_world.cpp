@@ -0,0 +1,344 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/board.h>
+#include <bananas_aruco/box_board.h>
+#include <bananas_aruco/grid_board.h>
+#include <bananas_aruco/renderer.h>
+#include <bananas_aruco/world.h>
+
+namespace {
+
+namespace affine_rotation = bananas::affine_rotation;
+namespace board = bananas::board;
+namespace renderer = bananas::renderer;
+namespace world = bananas::world;
+
+constexpr float pi{3.1415927F};
+const cv::Size image_size{1920, 1080};
+constexpr double focal_length{1400.0};
+/// The number of boxes that are actually visible in the rendered image. The
+/// rest of the registered boxes are somewhere else.
+constexpr std::int64_t visible_box_count{10};
+constexpr int first_box_marker_id{100};
+constexpr float box_side{0.15F};
+constexpr float box_marker_side{0.05F};
+constexpr float box_marker_offset{0.035F};
+/// The distance of the forward faces of the visible boxes from the camera.
+constexpr float box_distance{2.0F};
+
+/// Return the camera matrix for @p size, keeping the field of view the same
+/// at all resolutions.
+auto camera_matrix(cv::Size size = image_size) -> cv::Mat {
+    const double focal{focal_length * size.width / image_size.width};
+    return (cv::Mat_<double>(3, 3) << focal, 0.0, size.width / 2.0, 0.0,
+            focal, size.height / 2.0, 0.0, 0.0, 1.0);
+}
+
+/// Draw a black quad without any code where a marker would be. The detector
+/// rejects it as a marker candidate.
+void draw_blank(cv::Mat &image, const renderer::Renderer &renderer,
+                const std::vector<cv::Point3f> &corners) {
+    std::vector<cv::Point> points{};
+    for (const auto &point : renderer.project(corners)) {
+        points.emplace_back(cvRound(point.x), cvRound(point.y));
+    }
+    cv::fillConvexPoly(image, points, cv::Scalar{0});
+}
+
+auto box_settings(int first_id, int marker_count) -> board::BoxSettings {
+    board::BoxSettings settings{{box_side, box_side, box_side}, {}};
+    constexpr std::array<std::array<float, 2>, 4> offsets{
+        {{box_marker_offset, box_marker_offset},
+         {-box_marker_offset, box_marker_offset},
+         {-box_marker_offset, -box_marker_offset},
+         {box_marker_offset, -box_marker_offset}}};
+    for (int i{0}; i < marker_count; ++i) {
+        const auto [x_offset, y_offset]{offsets.at(i)};
+        settings.markers[board::BoxSettings::forward_face_index].push_back(
+            {first_id + i, x_offset, y_offset, 0.0F, box_marker_side});
+    }
+    return settings;
+}
+
+auto transformed(const affine_rotation::AffineRotation &transform,
+                 std::vector<cv::Point3f> points) -> std::vector<cv::Point3f> {
+    std::vector<cv::Point3f> result(points.size());
+    transform.transform(points, result);
+    return result;
+}
+
+/// A world with a static grid and @p box_count registered boxes, of which
+/// visible_box_count are rendered into @p image with @p markers_per_visible_box
+/// markers each. The camera is located at the world origin.
+struct Scene {
+    explicit Scene(std::int64_t box_count, int markers_per_visible_box = 4,
+                   cv::Size size = image_size)
+        : dictionary{cv::aruco::getPredefinedDictionary(
+              cv::aruco::DICT_5X5_1000)},
+          world{camera_matrix(size), cv::Mat{}, dictionary} {
+        const renderer::Renderer renderer{camera_matrix(size), cv::Mat{}, size,
+                                          dictionary, {255.0, 0.0, 0.0}};
+        std::vector<board::Board> boards{};
+        std::vector<affine_rotation::AffineRotation> placements{};
+
+        const board::GridSettings grid_settings{{3, 3}, 0.1F, 0.05F, 0};
+        const auto grid{board::make_board(grid_settings)};
+        // Face the camera, above the boxes.
+        const affine_rotation::AffineRotation grid_to_world{
+            Eigen::Quaternionf{
+                Eigen::AngleAxisf{-pi / 2.0F, Eigen::Vector3f::UnitX()}},
+            {0.0F, 0.35F, box_distance}};
+        world.makeStatic(world.addBoard(grid), grid_to_world);
+        boards.push_back(grid);
+        placements.push_back(grid_to_world);
+
+        constexpr float box_spacing{0.22F};
+        int next_id{first_box_marker_id};
+        for (std::int64_t i{0}; i < box_count; ++i) {
+            const bool visible{i < visible_box_count};
+            const auto box{board::make_board(
+                box_settings(next_id, visible ? markers_per_visible_box : 1))};
+            next_id += static_cast<int>(box.marker_ids.size());
+            world.addBoard(box);
+            if (!visible) {
+                continue;
+            }
+
+            // Turn the forward face towards the camera.
+            boards.push_back(box);
+            placements.emplace_back(
+                Eigen::Quaternionf{
+                    Eigen::AngleAxisf{pi, Eigen::Vector3f::UnitY()}},
+                Eigen::Vector3f{
+                    (static_cast<float>(i) -
+                     (static_cast<float>(visible_box_count - 1) / 2.0F)) *
+                        box_spacing,
+                    -0.2F, box_distance + (box_side / 2.0F)});
+        }
+
+        std::vector<renderer::BoardPose> poses{};
+        for (std::size_t i{0}; i < boards.size(); ++i) {
+            poses.push_back({&boards[i], placements[i]});
+        }
+        renderer.render(poses, image);
+
+        // Leave a marker undecodable on every other box so that those boxes
+        // are only partially detected.
+        for (std::size_t i{1}; i < boards.size(); i += 2) {
+            draw_blank(image, renderer,
+                       transformed(placements[i], boards[i].obj_points[0]));
+        }
+    }
+
+    cv::aruco::Dictionary dictionary;
+    world::World world;
+    cv::Mat image{};
+};
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void fit_with_registered_boxes(benchmark::State &state) {
+    Scene scene{state.range(0)};
+    std::size_t marker_count{0};
+    for (auto _ : state) {
+        auto result{scene.world.fit(scene.image)};
+        marker_count = result.ids.size();
+        benchmark::DoNotOptimize(result);
+    }
+    state.counters["markers"] = static_cast<double>(marker_count);
+}
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void fit_with_markers_per_box(benchmark::State &state) {
+    Scene scene{visible_box_count, static_cast<int>(state.range(0))};
+    world::FitWorkspace workspace{};
+    world::FitResult result{};
+    for (auto _ : state) {
+        scene.world.fit(scene.image, workspace, result);
+        benchmark::DoNotOptimize(result);
+    }
+    state.counters["boxes"] =
+        static_cast<double>(result.dynamic_board_placements.size());
+}
+
+/// Time fitting a frame state.range(0) pixels wide with a 16:9 aspect ratio.
+// NOLINTNEXTLINE(readability-identifier-naming)
+void fit_at_resolution(benchmark::State &state) {
+    const auto width{static_cast<int>(state.range(0))};
+    Scene scene{visible_box_count, 4, {width, width * 9 / 16}};
+    world::FitWorkspace workspace{};
+    world::FitResult result{};
+    for (auto _ : state) {
+        scene.world.fit(scene.image, workspace, result);
+        benchmark::DoNotOptimize(result);
+    }
+    state.counters["markers"] = static_cast<double>(result.ids.size());
+}
+
+/// Time creating a box with four markers on each of its first state.range(0)
+/// faces.
+// NOLINTNEXTLINE(readability-identifier-naming)
+void make_box_board(benchmark::State &state) {
+    const auto face_markers{
+        box_settings(0, 4).markers[board::BoxSettings::forward_face_index]};
+    board::BoxSettings settings{{box_side, box_side, box_side}, {}};
+    int next_id{0};
+    for (std::int64_t face{0}; face < state.range(0); ++face) {
+        auto &markers{settings.markers.at(static_cast<std::size_t>(face))};
+        markers = face_markers;
+        for (auto &marker : markers) {
+            marker.id = next_id++;
+        }
+    }
+    for (auto _ : state) {
+        auto box{board::make_board(settings)};
+        benchmark::DoNotOptimize(box);
+    }
+}
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void make_grid_board(benchmark::State &state) {
+    const auto side{static_cast<std::uint32_t>(state.range(0))};
+    const board::GridSettings settings{{side, side}, 0.1F, 0.02F, 0};
+    for (auto _ : state) {
+        auto grid{board::make_board(settings)};
+        benchmark::DoNotOptimize(grid);
+    }
+}
+
+/// Register @p grid_count small grids with unique marker IDs in a fresh
+/// World and time moving all of them into the static environment at once.
+// NOLINTNEXTLINE(readability-identifier-naming)
+void make_static(benchmark::State &state) {
+    const auto dictionary{
+        cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_1000)};
+    constexpr std::uint32_t grid_side{2};
+    const auto grid_count{state.range(0)};
+    std::vector<board::Board> grids{};
+    std::vector<std::pair<world::BoardId, affine_rotation::AffineRotation>>
+        placements{};
+    for (std::int64_t i{0}; i < grid_count; ++i) {
+        grids.push_back(board::make_board(board::GridSettings{
+            {grid_side, grid_side},
+            0.1F,
+            0.02F,
+            static_cast<int>(i * grid_side * grid_side)}));
+        placements.emplace_back(
+            static_cast<world::BoardId>(i),
+            affine_rotation::AffineRotation{
+                Eigen::Quaternionf::Identity(),
+                {static_cast<float>(i) * 0.5F, 0.0F, 0.0F}});
+    }
+
+    // Keep the World alive until the next iteration so that destroying it
+    // isn't timed.
+    std::optional<world::World> world{};
+    for (auto _ : state) {
+        state.PauseTiming();
+        world.emplace(camera_matrix(), cv::Mat{}, dictionary);
+        for (const auto &grid : grids) {
+            world->addBoard(grid);
+        }
+        state.ResumeTiming();
+
+        world->makeStatic(placements);
+        benchmark::ClobberMemory();
+    }
+}
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void compose_affine_rotations(benchmark::State &state) {
+    const affine_rotation::AffineRotation step{
+        Eigen::Quaternionf{
+            Eigen::AngleAxisf{0.01F, Eigen::Vector3f{1.0F, 2.0F, 3.0F}
+                                         .normalized()}},
+        {0.1F, 0.2F, 0.3F}};
+    affine_rotation::AffineRotation transform{};
+    for (auto _ : state) {
+        transform = step * transform;
+        benchmark::DoNotOptimize(transform);
+    }
+}
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void transform_points_one_by_one(benchmark::State &state) {
+    const affine_rotation::AffineRotation transform{
+        Eigen::Quaternionf{
+            Eigen::AngleAxisf{pi / 3.0F, Eigen::Vector3f::UnitY()}},
+        {0.1F, 0.2F, 0.3F}};
+    const std::vector<cv::Point3f> points(
+        static_cast<std::size_t>(state.range(0)), {0.1F, 0.2F, 0.3F});
+    std::vector<cv::Point3f> transformed_points(points.size());
+    for (auto _ : state) {
+        std::transform(points.cbegin(), points.cend(),
+                       transformed_points.begin(),
+                       [&transform](cv::Point3f point) {
+                           return transform * point;
+                       });
+        benchmark::DoNotOptimize(transformed_points.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void transform_points(benchmark::State &state) {
+    const affine_rotation::AffineRotation transform{
+        Eigen::Quaternionf{
+            Eigen::AngleAxisf{pi / 3.0F, Eigen::Vector3f::UnitY()}},
+        {0.1F, 0.2F, 0.3F}};
+    const std::vector<cv::Point3f> points(
+        static_cast<std::size_t>(state.range(0)), {0.1F, 0.2F, 0.3F});
+    std::vector<cv::Point3f> transformed_points(points.size());
+    for (auto _ : state) {
+        transform.transform(points, transformed_points);
+        benchmark::DoNotOptimize(transformed_points.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // namespace
+
+BENCHMARK(fit_with_registered_boxes)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(500)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(fit_with_markers_per_box)
+    ->DenseRange(2, 4)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(fit_at_resolution)
+    ->Arg(640)
+    ->Arg(1280)
+    ->Arg(1920)
+    ->Arg(3840)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(make_box_board)->DenseRange(1, 6);
+BENCHMARK(make_grid_board)->Arg(2)->Arg(8)->Arg(16);
+BENCHMARK(make_static)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(250)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(compose_affine_rotations);
+BENCHMARK(transform_points_one_by_one)->Arg(4)->Arg(1024);
+BENCHMARK(transform_points)->Arg(4)->Arg(1024);
+
+BENCHMARK_MAIN();
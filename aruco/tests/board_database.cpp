@@ -0,0 +1,226 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gsl/span>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <opencv2/core/types.hpp>
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/board.h>
+#include <bananas_aruco/board_database.h>
+#include <bananas_aruco/world.h>
+
+// LINT: gtest macros quickly bump this metric up.
+// NOLINTBEGIN(readability-function-cognitive-complexity)
+
+namespace {
+
+namespace affine_rotation = bananas::affine_rotation;
+namespace board = bananas::board;
+namespace board_database = bananas::board_database;
+
+/// A file in the temporary directory that is removed at the end of the test.
+class TemporaryFile {
+  public:
+    explicit TemporaryFile(const std::string &name)
+        : path_{std::filesystem::temp_directory_path() / name} {}
+    ~TemporaryFile() { std::filesystem::remove(path_); }
+
+    TemporaryFile(const TemporaryFile &) = delete;
+    TemporaryFile(TemporaryFile &&) = delete;
+    auto operator=(const TemporaryFile &) -> TemporaryFile & = delete;
+    auto operator=(TemporaryFile &&) -> TemporaryFile & = delete;
+
+    [[nodiscard]] auto path() const -> std::string { return path_.string(); }
+
+  private:
+    std::filesystem::path path_;
+};
+
+auto square_marker(float x, float z) -> std::vector<cv::Point3f> {
+    return {{x, 0.0F, z},
+            {x + 0.1F, 0.0F, z},
+            {x + 0.1F, 0.0F, z + 0.1F},
+            {x, 0.0F, z + 0.1F}};
+}
+
+auto make_boards() -> std::vector<board::Board> {
+    return {{{square_marker(0.0F, 0.0F), square_marker(0.2F, 0.0F)}, {0, 1}},
+            {{square_marker(0.0F, 0.5F)}, {7}},
+            {{square_marker(1.0F, 1.0F), square_marker(1.2F, 1.0F),
+              square_marker(1.4F, 1.0F)},
+             {2, 3, 4}}};
+}
+
+void write_database(const std::string &path,
+                    const std::vector<board::Board> &boards,
+                    const board_database::StaticPlacements &placements,
+                    std::uint64_t checksum) {
+    std::ofstream output{path, std::ios::binary};
+    board_database::write(output, boards, placements, checksum);
+}
+
+/// Write stand-ins for the board and the static environment files to
+/// @p sources and a database of make_boards() compiled from them to @p path.
+/// Board 2 is static.
+void compile_database(const std::string &path,
+                      const std::array<std::string, 2> &sources) {
+    std::ofstream{sources[0]} << R"([{"grid": "boards"}])";
+    std::ofstream{sources[1]} << R"({"2": "placement"})";
+    write_database(path, make_boards(), {{2, {}}},
+                   board_database::source_checksum(sources));
+}
+
+} // namespace
+
+TEST(BoardDatabaseTest, Fnv1aMatchesReferenceValues) {
+    EXPECT_EQ(board_database::fnv1a({}), 0xcbf29ce484222325ULL);
+    const std::array<std::byte, 1> a{std::byte{'a'}};
+    EXPECT_EQ(board_database::fnv1a(a), 0xaf63dc4c8601ec8cULL);
+    const std::array<std::byte, 6> foobar{
+        std::byte{'f'}, std::byte{'o'}, std::byte{'o'},
+        std::byte{'b'}, std::byte{'a'}, std::byte{'r'}};
+    EXPECT_EQ(board_database::fnv1a(foobar), 0x85944171f73967e8ULL);
+}
+
+TEST(BoardDatabaseTest, ChecksumDependsOnAllSources) {
+    const TemporaryFile first{"bananas_board_database_first.json"};
+    const TemporaryFile second{"bananas_board_database_second.json"};
+    std::ofstream{first.path()} << "[1, 2]";
+    std::ofstream{second.path()} << "{}";
+    const std::array paths{first.path(), second.path()};
+    const auto checksum{board_database::source_checksum(paths)};
+
+    std::ofstream{second.path()} << "{ }";
+    EXPECT_NE(board_database::source_checksum(paths), checksum);
+
+    const std::array missing{first.path() + ".missing"};
+    EXPECT_THROW(static_cast<void>(board_database::source_checksum(missing)),
+                 std::runtime_error);
+}
+
+TEST(BoardDatabaseTest, RoundTripsBoardsAndPlacements) {
+    const TemporaryFile file{"bananas_board_database_round_trip.bin"};
+    const auto boards{make_boards()};
+    const board_database::StaticPlacements placements{
+        {2, {Eigen::Quaternionf{Eigen::AngleAxisf{
+                 0.5F, Eigen::Vector3f::UnitY()}},
+             {1.0F, 2.0F, 3.0F}}},
+        {0, {}}};
+    write_database(file.path(), boards, placements, 1234);
+
+    const board_database::BoardDatabase database{file.path()};
+    EXPECT_EQ(database.sourceChecksum(), std::uint64_t{1234});
+    ASSERT_EQ(database.boardCount(), boards.size());
+    for (std::size_t id{0}; id < boards.size(); ++id) {
+        const auto loaded{database.board(static_cast<std::uint32_t>(id))};
+        EXPECT_EQ(loaded.marker_ids, boards[id].marker_ids);
+        EXPECT_EQ(loaded.obj_points, boards[id].obj_points);
+    }
+
+    const auto loaded_placements{database.staticPlacements()};
+    ASSERT_EQ(loaded_placements.size(), placements.size());
+    for (std::size_t i{0}; i < placements.size(); ++i) {
+        EXPECT_EQ(loaded_placements[i].first, placements[i].first);
+        EXPECT_EQ(loaded_placements[i].second.getTranslation(),
+                  placements[i].second.getTranslation());
+        EXPECT_EQ(loaded_placements[i].second.getRotation().coeffs(),
+                  placements[i].second.getRotation().coeffs());
+    }
+}
+
+TEST(BoardDatabaseTest, RejectsInvalidFiles) {
+    const TemporaryFile file{"bananas_board_database_invalid.bin"};
+    EXPECT_THROW(board_database::BoardDatabase{file.path()},
+                 std::runtime_error);
+
+    std::ofstream{file.path()} << "not a board database at all, but long "
+                                  "enough to have a header";
+    EXPECT_THROW(board_database::BoardDatabase{file.path()},
+                 std::runtime_error);
+
+    write_database(file.path(), make_boards(), {}, 0);
+    const auto size{std::filesystem::file_size(file.path())};
+    std::filesystem::resize_file(file.path(), size - 1);
+    EXPECT_THROW(board_database::BoardDatabase{file.path()},
+                 std::runtime_error);
+
+    write_database(file.path(), make_boards(), {}, 0);
+    {
+        // Bump the format version.
+        std::fstream stream{file.path(),
+                            std::ios::in | std::ios::out | std::ios::binary};
+        stream.seekp(8);
+        const std::uint32_t version{board_database::format_version + 1};
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        stream.write(reinterpret_cast<const char *>(&version),
+                     sizeof(version));
+    }
+    EXPECT_THROW(board_database::BoardDatabase{file.path()},
+                 std::runtime_error);
+}
+
+TEST(BoardDatabaseTest, LoadsModelCompiledFromTheSources) {
+    const TemporaryFile file{"bananas_board_database_current.bin"};
+    const TemporaryFile boards{"bananas_board_database_current_boards.json"};
+    const TemporaryFile environment{
+        "bananas_board_database_current_env.json"};
+    const std::array sources{boards.path(), environment.path()};
+    compile_database(file.path(), sources);
+    const auto dictionary{
+        cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_100)};
+
+    const auto model{
+        board_database::load_model(dictionary, file.path(), sources)};
+    EXPECT_EQ(model->boardCount(), std::size_t{3});
+    EXPECT_TRUE(model->staticMarkerOffset(2).has_value());
+    EXPECT_FALSE(model->staticMarkerOffset(0).has_value());
+}
+
+TEST(BoardDatabaseTest, RejectsModelOfChangedSources) {
+    const TemporaryFile file{"bananas_board_database_stale.bin"};
+    const TemporaryFile boards{"bananas_board_database_stale_boards.json"};
+    const TemporaryFile environment{"bananas_board_database_stale_env.json"};
+    const std::array sources{boards.path(), environment.path()};
+    compile_database(file.path(), sources);
+    const auto dictionary{
+        cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_100)};
+
+    std::ofstream{boards.path()} << R"([{"grid": "other boards"}])";
+    EXPECT_THROW(static_cast<void>(board_database::load_model(
+                     dictionary, file.path(), sources)),
+                 std::runtime_error);
+}
+
+TEST(BoardDatabaseTest, LoadsModelWithoutChecking) {
+    const TemporaryFile file{"bananas_board_database_unchecked.bin"};
+    const TemporaryFile boards{"bananas_board_database_unchecked_boards.json"};
+    const TemporaryFile environment{
+        "bananas_board_database_unchecked_env.json"};
+    const std::array sources{boards.path(), environment.path()};
+    compile_database(file.path(), sources);
+    const auto dictionary{
+        cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_100)};
+
+    // The sources are only read when they are given.
+    std::filesystem::remove(boards.path());
+    const auto model{board_database::load_model(dictionary, file.path())};
+    EXPECT_EQ(model->boardCount(), std::size_t{3});
+    EXPECT_TRUE(model->staticMarkerOffset(2).has_value());
+}
+
+// NOLINTEND(readability-function-cognitive-complexity)
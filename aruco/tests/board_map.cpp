@@ -0,0 +1,144 @@
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include <bananas_aruco/board_map.h>
+#include <bananas_aruco/marker_index.h>
+#include <bananas_aruco/world.h>
+
+// NOLINTNEXTLINE(google-build-using-namespace)
+using namespace nlohmann::json_literals;
+
+// LINT: gtest macros quickly bump this metric up.
+// NOLINTBEGIN(readability-function-cognitive-complexity)
+
+namespace {
+
+namespace world = bananas::world;
+
+} // namespace
+
+TEST(BoardMapTest, StoresValues) {
+    world::BoardMap<int> map{};
+    EXPECT_TRUE(map.empty());
+
+    EXPECT_TRUE(map.emplace(3, 30));
+    EXPECT_TRUE(map.emplace(1, 10));
+    EXPECT_FALSE(map.emplace(3, 31));
+    EXPECT_EQ(map.size(), std::size_t{2});
+
+    EXPECT_TRUE(map.contains(1));
+    EXPECT_FALSE(map.contains(2));
+    EXPECT_FALSE(map.contains(100));
+    EXPECT_EQ(map.at(3), 30);
+    EXPECT_THROW((void)map.at(2), std::out_of_range);
+    ASSERT_NE(map.find(1), nullptr);
+    EXPECT_EQ(*map.find(1), 10);
+    EXPECT_EQ(map.find(0), nullptr);
+
+    map.insert_or_assign(3, 32);
+    map.insert_or_assign(0, 0);
+    EXPECT_EQ(map.at(3), 32);
+    EXPECT_EQ(map.size(), std::size_t{3});
+
+    map.erase(1);
+    map.erase(2);
+    EXPECT_FALSE(map.contains(1));
+    EXPECT_EQ(map.size(), std::size_t{2});
+
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_FALSE(map.contains(3));
+}
+
+TEST(BoardMapTest, IteratesInIdOrder) {
+    world::BoardMap<int> map{};
+    map.emplace(5, 50);
+    map.emplace(0, 0);
+    map.emplace(2, 20);
+
+    std::vector<std::pair<world::BoardId, int>> entries{};
+    for (auto [id, value] : map) {
+        value += 1;
+        entries.emplace_back(id, value);
+    }
+    const std::vector<std::pair<world::BoardId, int>> expected{
+        {0, 1}, {2, 21}, {5, 51}};
+    EXPECT_EQ(entries, expected);
+    EXPECT_EQ(map.at(2), 21);
+
+    const auto &const_map{map};
+    std::size_t count{0};
+    for (const auto &[id, value] : const_map) {
+        EXPECT_EQ(value, static_cast<int>(id * 10) + 1);
+        ++count;
+    }
+    EXPECT_EQ(count, map.size());
+}
+
+TEST(BoardMapTest, ReusesStorageAfterClear) {
+    world::BoardMap<int> map{};
+    map.emplace(7, 70);
+    map.emplace(2, 20);
+    map.emplace(4, 40);
+    map.erase(7);
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.begin(), map.end());
+
+    EXPECT_TRUE(map.emplace(7, 71));
+    map.insert_or_assign(2, 21);
+    EXPECT_EQ(map.size(), std::size_t{2});
+    EXPECT_FALSE(map.contains(4));
+    EXPECT_EQ(map.at(7), 71);
+    EXPECT_EQ(map.at(2), 21);
+}
+
+TEST(BoardMapTest, ParsesPlacementJson) {
+    const auto json(R"([
+        {
+            "id": 2,
+            "board_to_world": {
+                "translation": [1.0, 2.0, 3.0],
+                "rotation": [1.0, 0.0, 0.0, 0.0]
+            }
+        },
+        {
+            "id": 0,
+            "board_to_world": {
+                "translation": [4.0, 5.0, 6.0],
+                "rotation": [1.0, 0.0, 0.0, 0.0]
+            }
+        }
+    ])"_json);
+
+    world::BoardPlacement placement{};
+    world::from_json(json, placement);
+    EXPECT_EQ(placement.size(), std::size_t{2});
+    EXPECT_FALSE(placement.contains(1));
+    EXPECT_FLOAT_EQ(placement.at(2).getTranslation().x(), 1.0F);
+    EXPECT_FLOAT_EQ(placement.at(0).getTranslation().z(), 6.0F);
+}
+
+TEST(BoardMapTest, RejectsHugeBoardIds) {
+    // Storing this would take an array of four billion entries.
+    const auto json(R"([
+        {
+            "id": 4000000000,
+            "board_to_world": {
+                "translation": [1.0, 2.0, 3.0],
+                "rotation": [1.0, 0.0, 0.0, 0.0]
+            }
+        }
+    ])"_json);
+
+    world::BoardPlacement placement{};
+    EXPECT_THROW(world::from_json(json, placement), std::invalid_argument);
+}
+
+// NOLINTEND(readability-function-cognitive-complexity)
@@ -0,0 +1,94 @@
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include <opencv2/objdetect/aruco_detector.hpp>
+
+#include <bananas_aruco/detector_config.h>
+
+// NOLINTNEXTLINE(google-build-using-namespace)
+using namespace nlohmann::json_literals;
+
+// LINT: gtest macros quickly bump this metric up.
+// NOLINTBEGIN(readability-function-cognitive-complexity)
+
+namespace {
+
+namespace detector_config = bananas::detector_config;
+
+} // namespace
+
+TEST(DetectorConfigTest, DefaultPresetMatchesOpenCV) {
+    const auto config{detector_config::preset("default")};
+    const cv::aruco::DetectorParameters defaults{};
+    EXPECT_EQ(config.detector.adaptiveThreshWinSizeMax,
+              defaults.adaptiveThreshWinSizeMax);
+    EXPECT_EQ(config.detector.cornerRefinementMethod,
+              defaults.cornerRefinementMethod);
+}
+
+TEST(DetectorConfigTest, PresetsTradeAccuracyForSpeed) {
+    const auto fast{detector_config::preset("fast")};
+    const auto accurate{detector_config::preset("accurate")};
+    EXPECT_EQ(fast.detector.cornerRefinementMethod,
+              cv::aruco::CORNER_REFINE_NONE);
+    EXPECT_EQ(accurate.detector.cornerRefinementMethod,
+              cv::aruco::CORNER_REFINE_SUBPIX);
+    EXPECT_LT(fast.detector.adaptiveThreshWinSizeMax,
+              accurate.detector.adaptiveThreshWinSizeMax);
+    EXPECT_THROW((void)detector_config::preset("slow"), std::invalid_argument);
+}
+
+TEST(DetectorConfigTest, JsonOverridesPreset) {
+    const auto json(R"(
+        {
+            "preset": "fast",
+            "detector": {
+                "adaptive_thresh_win_size_max": 13,
+                "corner_refinement_method": "contour"
+            },
+            "refine": {"min_rep_distance": 5.0}
+        }
+    )"_json);
+    const auto config{json.get<detector_config::DetectorConfig>()};
+    const auto fast{detector_config::preset("fast")};
+    EXPECT_EQ(config.detector.adaptiveThreshWinSizeMax, 13);
+    EXPECT_EQ(config.detector.cornerRefinementMethod,
+              cv::aruco::CORNER_REFINE_CONTOUR);
+    EXPECT_EQ(config.detector.adaptiveThreshWinSizeMin,
+              fast.detector.adaptiveThreshWinSizeMin);
+    EXPECT_FLOAT_EQ(config.refine.minRepDistance, 5.0F);
+    EXPECT_EQ(config.refine.checkAllOrders, fast.refine.checkAllOrders);
+}
+
+TEST(DetectorConfigTest, ParsesPresetName) {
+    const auto config{
+        nlohmann::json("accurate").get<detector_config::DetectorConfig>()};
+    EXPECT_EQ(config.detector.cornerRefinementMethod,
+              cv::aruco::CORNER_REFINE_SUBPIX);
+}
+
+TEST(DetectorConfigTest, RejectsUnknownRefinementMethod) {
+    const auto json(
+        R"({"detector": {"corner_refinement_method": "magic"}})"_json);
+    EXPECT_THROW((void)json.get<detector_config::DetectorConfig>(),
+                 std::invalid_argument);
+}
+
+TEST(DetectorConfigTest, RoundTripsThroughJson) {
+    auto config{detector_config::preset("accurate")};
+    config.detector.minMarkerPerimeterRate = 0.125;
+    config.refine.errorCorrectionRate = 2.5F;
+    const nlohmann::json json(config);
+    const auto parsed{json.get<detector_config::DetectorConfig>()};
+    EXPECT_EQ(parsed.detector.adaptiveThreshWinSizeStep,
+              config.detector.adaptiveThreshWinSizeStep);
+    EXPECT_DOUBLE_EQ(parsed.detector.minMarkerPerimeterRate, 0.125);
+    EXPECT_EQ(parsed.detector.cornerRefinementMethod,
+              config.detector.cornerRefinementMethod);
+    EXPECT_FLOAT_EQ(parsed.refine.errorCorrectionRate, 2.5F);
+}
+
+// NOLINTEND(readability-function-cognitive-complexity)
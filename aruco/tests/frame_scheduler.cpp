@@ -0,0 +1,54 @@
+#include <chrono>
+#include <cstddef>
+
+#include <gtest/gtest.h>
+
+#include <bananas_aruco/frame_scheduler.h>
+
+// LINT: gtest macros quickly bump this metric up.
+// NOLINTBEGIN(readability-function-cognitive-complexity)
+
+namespace {
+
+namespace frame_scheduler = bananas::frame_scheduler;
+
+using std::chrono::milliseconds;
+
+} // namespace
+
+TEST(FrameSchedulerTest, HoldsFramesUntilTheirTimestamp) {
+    frame_scheduler::FrameScheduler scheduler{milliseconds{20}};
+    const frame_scheduler::Clock::time_point start{milliseconds{1000}};
+
+    EXPECT_EQ(scheduler.schedule(milliseconds{0}, start), start);
+    EXPECT_EQ(scheduler.schedule(milliseconds{40}, start + milliseconds{5}),
+              start + milliseconds{40});
+    EXPECT_EQ(scheduler.schedule(milliseconds{80}, start + milliseconds{95}),
+              start + milliseconds{80});
+
+    const auto statistics{scheduler.statistics()};
+    EXPECT_EQ(statistics.processed, std::size_t{3});
+    EXPECT_EQ(statistics.dropped, std::size_t{0});
+}
+
+TEST(FrameSchedulerTest, DropsLateFrames) {
+    frame_scheduler::FrameScheduler scheduler{milliseconds{20}};
+    const frame_scheduler::Clock::time_point start{milliseconds{1000}};
+
+    // The playback clock starts from the first frame, whatever its timestamp.
+    EXPECT_EQ(scheduler.schedule(milliseconds{500}, start), start);
+    // Processing the first frame took 150 ms, so the next three frames are
+    // more than 20 ms late.
+    const auto late{start + milliseconds{150}};
+    EXPECT_FALSE(scheduler.schedule(milliseconds{540}, late).has_value());
+    EXPECT_FALSE(scheduler.schedule(milliseconds{580}, late).has_value());
+    EXPECT_FALSE(scheduler.schedule(milliseconds{620}, late).has_value());
+    EXPECT_EQ(scheduler.schedule(milliseconds{660}, late),
+              start + milliseconds{160});
+
+    const auto statistics{scheduler.statistics()};
+    EXPECT_EQ(statistics.processed, std::size_t{2});
+    EXPECT_EQ(statistics.dropped, std::size_t{3});
+}
+
+// NOLINTEND(readability-function-cognitive-complexity)
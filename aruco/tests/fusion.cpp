@@ -0,0 +1,204 @@
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/fusion.h>
+#include <bananas_aruco/world.h>
+
+// LINT: gtest macros quickly bump this metric up.
+// NOLINTBEGIN(readability-function-cognitive-complexity)
+
+namespace {
+
+namespace affine_rotation = bananas::affine_rotation;
+namespace fusion = bananas::fusion;
+namespace world = bananas::world;
+
+using std::chrono::milliseconds;
+
+constexpr float error_bound{1E-5};
+
+auto yawed(float yaw, Eigen::Vector3f translation)
+    -> affine_rotation::AffineRotation {
+    return {Eigen::Quaternionf{
+                Eigen::AngleAxisf{yaw, Eigen::Vector3f::UnitY()}},
+            translation};
+}
+
+void expect_near(const affine_rotation::AffineRotation &actual,
+                 const affine_rotation::AffineRotation &expected) {
+    EXPECT_TRUE(actual.getTranslation().isApprox(expected.getTranslation(),
+                                                 error_bound))
+        << actual.getTranslation().transpose();
+    EXPECT_NEAR(
+        actual.getRotation().angularDistance(expected.getRotation()), 0.0F,
+        error_bound);
+}
+
+/// The result of a camera at @p camera_to_drone on a drone at
+/// @p drone_to_world.
+auto camera_result(const affine_rotation::AffineRotation &camera_to_drone,
+                   const affine_rotation::AffineRotation &drone_to_world,
+                   float reprojection_error, fusion::Clock::time_point time)
+    -> world::FitResult {
+    world::FitResult result{};
+    result.camera_to_world =
+        world::UncertainPose{reprojection_error,
+                             drone_to_world * camera_to_drone};
+    result.capture_time = time;
+    return result;
+}
+
+} // namespace
+
+TEST(FusionTest, AverageWeighsByReprojectionError) {
+    const std::vector<world::UncertainPose> poses{
+        {1.0F, yawed(0.0F, {0.0F, 0.0F, 0.0F})},
+        {2.0F, yawed(0.5F, {1.0F, 0.0F, 0.0F})}};
+
+    const auto average{fusion::average(poses)};
+
+    // The weights are 1 and 1/4.
+    EXPECT_NEAR(average.placement.getTranslation().x(), 0.2F, error_bound);
+    EXPECT_NEAR(average.reprojection_error, 1.2F, error_bound);
+    const float yaw{
+        Eigen::AngleAxisf{average.placement.getRotation()}.angle()};
+    EXPECT_GT(yaw, 0.0F);
+    EXPECT_LT(yaw, 0.25F);
+}
+
+TEST(FusionTest, AverageTreatsOppositeQuaternionsAlike) {
+    const auto placement{yawed(0.3F, {0.0F, 0.0F, 0.0F})};
+    const Eigen::Quaternionf flipped{-placement.getRotation().coeffs()};
+    const std::vector<world::UncertainPose> poses{
+        {1.0F, placement},
+        {1.0F, {flipped, placement.getTranslation()}}};
+
+    expect_near(fusion::average(poses).placement, placement);
+}
+
+TEST(FusionTest, CombinesCamerasIntoTheDronePose) {
+    const std::vector<affine_rotation::AffineRotation> camera_to_drone{
+        yawed(0.0F, {0.1F, 0.0F, 0.0F}),
+        yawed(3.1415927F, {-0.1F, 0.0F, 0.0F})};
+    fusion::Fuser fuser{camera_to_drone, milliseconds{20}};
+    const auto drone_to_world{yawed(1.0F, {2.0F, 1.0F, 3.0F})};
+    const fusion::Clock::time_point start{milliseconds{1000}};
+
+    fusion::FusedResult fused{};
+    fuser.update(0, camera_result(camera_to_drone[0], drone_to_world, 1.0F,
+                                  start),
+                 fused);
+    ASSERT_TRUE(fused.drone_to_world.has_value());
+    expect_near(fused.drone_to_world->placement, drone_to_world);
+    EXPECT_EQ(fused.camera_count, std::size_t{1});
+
+    fuser.update(1, camera_result(camera_to_drone[1], drone_to_world, 1.0F,
+                                  start + milliseconds{10}),
+                 fused);
+    ASSERT_TRUE(fused.drone_to_world.has_value());
+    expect_near(fused.drone_to_world->placement, drone_to_world);
+    EXPECT_EQ(fused.camera_count, std::size_t{2});
+    EXPECT_EQ(fused.capture_time, start + milliseconds{10});
+}
+
+TEST(FusionTest, LeavesOutStaleCameras) {
+    const std::vector<affine_rotation::AffineRotation> camera_to_drone(2);
+    fusion::Fuser fuser{camera_to_drone, milliseconds{20}};
+    const fusion::Clock::time_point start{milliseconds{1000}};
+
+    fusion::FusedResult fused{};
+    fuser.update(0,
+                 camera_result(camera_to_drone[0],
+                               yawed(0.0F, {5.0F, 0.0F, 0.0F}), 1.0F, start),
+                 fused);
+    // The second camera doesn't see the static environment.
+    world::FitResult result{};
+    result.capture_time = start + milliseconds{50};
+    fuser.update(1, result, fused);
+
+    EXPECT_FALSE(fused.drone_to_world.has_value());
+    EXPECT_EQ(fused.camera_count, std::size_t{1});
+}
+
+TEST(FusionTest, CombinesBoardPlacements) {
+    const std::vector<affine_rotation::AffineRotation> camera_to_drone(2);
+    fusion::Fuser fuser{camera_to_drone, milliseconds{20}};
+    const fusion::Clock::time_point start{milliseconds{1000}};
+    constexpr world::BoardId board_id{3};
+
+    fusion::FusedResult fused{};
+    world::FitResult result{};
+    result.capture_time = start;
+    result.dynamic_board_placements.emplace(
+        board_id, {1.0F, yawed(0.0F, {1.0F, 0.0F, 0.0F})});
+    fuser.update(0, result, fused);
+    result.dynamic_board_placements.clear();
+    result.dynamic_board_placements.emplace(
+        board_id, {1.0F, yawed(0.0F, {2.0F, 0.0F, 0.0F})});
+    fuser.update(1, result, fused);
+
+    ASSERT_EQ(fused.dynamic_board_placements.size(), std::size_t{1});
+    expect_near(fused.dynamic_board_placements.at(board_id).placement,
+                yawed(0.0F, {1.5F, 0.0F, 0.0F}));
+}
+
+TEST(FusionTest, WritesFusedBoardPlacements) {
+    const std::vector<affine_rotation::AffineRotation> camera_to_drone(2);
+    fusion::Fuser fuser{camera_to_drone, milliseconds{20}};
+    const fusion::Clock::time_point start{milliseconds{1000}};
+    constexpr world::BoardId board_id{3};
+
+    fusion::FusedResult fused{};
+    auto result{camera_result(camera_to_drone[0], {}, 1.0F, start)};
+    result.dynamic_board_placements.emplace(
+        board_id, {1.0F, yawed(0.0F, {1.0F, 0.0F, 0.0F})});
+    fuser.update(0, result, fused);
+    result.dynamic_board_placements.clear();
+    result.dynamic_board_placements.emplace(
+        board_id, {2.0F, yawed(0.0F, {2.0F, 0.0F, 0.0F})});
+    fuser.update(1, result, fused);
+
+    const nlohmann::json boards(fused.dynamic_board_placements);
+    ASSERT_TRUE(boards.is_array());
+    ASSERT_EQ(boards.size(), std::size_t{1});
+    EXPECT_EQ(boards[0].at("id").get<world::BoardId>(), board_id);
+    // The weights are 1 and 1/4.
+    EXPECT_NEAR(boards[0].at("reprojection_error").get<float>(), 1.2F,
+                error_bound);
+    expect_near(
+        boards[0].at("board_to_world").get<affine_rotation::AffineRotation>(),
+        yawed(0.0F, {1.2F, 0.0F, 0.0F}));
+}
+
+TEST(FusionTest, LateResultsCanBeOlderThanTheLastFusedOne) {
+    const std::vector<affine_rotation::AffineRotation> camera_to_drone(2);
+    fusion::Fuser fuser{camera_to_drone, milliseconds{20}};
+    const fusion::Clock::time_point start{milliseconds{1000}};
+    const auto drone_to_world{yawed(0.0F, {1.0F, 0.0F, 0.0F})};
+
+    fusion::FusedResult fused{};
+    fuser.update(0, camera_result(camera_to_drone[0], drone_to_world, 1.0F,
+                                  start + milliseconds{40}),
+                 fused);
+    const auto newest{fused.capture_time};
+    // The slower camera finishes an older frame only now, which is too old
+    // to be fused with the newer one.
+    fuser.update(1, camera_result(camera_to_drone[1], drone_to_world, 1.0F,
+                                  start + milliseconds{15}),
+                 fused);
+
+    ASSERT_TRUE(fused.drone_to_world.has_value());
+    EXPECT_EQ(fused.camera_count, std::size_t{1});
+    EXPECT_LT(fused.capture_time, newest);
+}
+
+// NOLINTEND(readability-function-cognitive-complexity)
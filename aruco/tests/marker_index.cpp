@@ -0,0 +1,84 @@
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <bananas_aruco/marker_index.h>
+
+// LINT: gtest macros quickly bump this metric up.
+// NOLINTBEGIN(readability-function-cognitive-complexity)
+
+namespace {
+
+namespace world = bananas::world;
+
+} // namespace
+
+TEST(MarkerIndexTest, FindsMarkers) {
+    world::MarkerIndex index{100};
+    index.addBoard(0, {3, 1, 4});
+    index.addBoard(1, {15, 9});
+
+    const auto location{index.find(4)};
+    ASSERT_TRUE(location.has_value());
+    EXPECT_EQ(location->board, 0);
+    EXPECT_EQ(location->marker, 2);
+
+    const auto other_location{index.find(15)};
+    ASSERT_TRUE(other_location.has_value());
+    EXPECT_EQ(other_location->board, 1);
+    EXPECT_EQ(other_location->marker, 0);
+
+    EXPECT_FALSE(index.find(2).has_value());
+    EXPECT_FALSE(index.find(-1).has_value());
+    EXPECT_FALSE(index.find(100).has_value());
+}
+
+TEST(MarkerIndexTest, RejectsDuplicateMarkers) {
+    world::MarkerIndex index{100};
+    index.addBoard(0, {3, 1, 4});
+
+    EXPECT_THROW(index.addBoard(1, {5, 1}), std::invalid_argument);
+    EXPECT_THROW(index.addBoard(1, {5, 5}), std::invalid_argument);
+    EXPECT_THROW(index.addBoard(1, {5, 100}), std::invalid_argument);
+
+    // Failed additions must not leave anything behind.
+    EXPECT_FALSE(index.find(5).has_value());
+    EXPECT_EQ(index.boardCount(), 1);
+    index.addBoard(1, {5});
+    EXPECT_EQ(index.boardCount(), 2);
+}
+
+TEST(MarkerIndexTest, PartitionsDetections) {
+    world::MarkerIndex index{100};
+    index.addBoard(0, {3, 1, 4});
+    index.addBoard(1, {15, 9});
+    index.addBoard(2, {26});
+
+    world::DetectionBuckets buckets{};
+    index.partition({9, 50, 4, 3}, buckets);
+
+    const std::vector<world::BoardId> expected_boards{1, 0};
+    EXPECT_EQ(buckets.boards, expected_boards);
+    ASSERT_EQ(buckets.matches.size(), 3);
+    ASSERT_EQ(buckets.matches[0].size(), 2);
+    EXPECT_EQ(buckets.matches[0][0].detection, 2);
+    EXPECT_EQ(buckets.matches[0][0].marker, 2);
+    EXPECT_EQ(buckets.matches[0][1].detection, 3);
+    EXPECT_EQ(buckets.matches[0][1].marker, 0);
+    ASSERT_EQ(buckets.matches[1].size(), 1);
+    EXPECT_EQ(buckets.matches[1][0].detection, 0);
+    EXPECT_EQ(buckets.matches[1][0].marker, 1);
+    EXPECT_TRUE(buckets.matches[2].empty());
+
+    // Reusing the buckets must not keep stale matches around.
+    index.partition({26}, buckets);
+    const std::vector<world::BoardId> expected_reused_boards{2};
+    EXPECT_EQ(buckets.boards, expected_reused_boards);
+    EXPECT_TRUE(buckets.matches[0].empty());
+    EXPECT_TRUE(buckets.matches[1].empty());
+    ASSERT_EQ(buckets.matches[2].size(), 1);
+    EXPECT_EQ(buckets.matches[2][0].detection, 0);
+}
+
+// NOLINTEND(readability-function-cognitive-complexity)
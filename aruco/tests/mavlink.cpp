@@ -1,4 +1,11 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -17,6 +24,25 @@ constexpr float pi{3.1415927F};
 // constant absolute bound instead.
 constexpr float error_bound{1E-6};
 
+auto estimate_at(float x) -> mavsdk::Mocap::VisionPositionEstimate {
+    mavsdk::Mocap::VisionPositionEstimate estimate{};
+    estimate.position_body.x_m = x;
+    return estimate;
+}
+
+/// Wait for up to a second for @p condition to become true.
+auto eventually(const std::function<bool()> &condition) -> bool {
+    const auto deadline{std::chrono::steady_clock::now() +
+                        std::chrono::seconds{1}};
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    return true;
+}
+
 } // namespace
 
 TEST(BananasMavlinkTest, DronePositionEstimateWorks) {
@@ -25,6 +51,9 @@ TEST(BananasMavlinkTest, DronePositionEstimateWorks) {
             Eigen::AngleAxisf{pi / 2.0F, Eigen::Vector3f::UnitX()}},
         Eigen::Vector3f{0.0F, -0.125F, 0.0F}};
 
+    const std::chrono::steady_clock::time_point capture_time{
+        std::chrono::milliseconds{1500}};
+
     for (int x_i{-1}; x_i <= 1; ++x_i) {
         for (int z_i{-1}; z_i <= 1; ++z_i) {
             for (int yaw_i{0}; yaw_i <= 4; ++yaw_i) {
@@ -43,7 +72,9 @@ TEST(BananasMavlinkTest, DronePositionEstimateWorks) {
 
                 const auto position_estimate{
                     bananas::mavlink::drone_position_estimate(
-                        camera_to_drone, {0.0F, camera_to_world})};
+                        camera_to_drone, {0.0F, camera_to_world},
+                        capture_time)};
+                EXPECT_EQ(position_estimate.time_usec, 1'500'000U);
                 EXPECT_NEAR(position_estimate.position_body.x_m, z,
                             error_bound);
                 EXPECT_NEAR(position_estimate.position_body.y_m, -x,
@@ -66,3 +97,103 @@ TEST(BananasMavlinkTest, DronePositionEstimateWorks) {
         }
     }
 }
+
+TEST(PoseSenderTest, SendsOnlyTheLatestEstimate) {
+    std::mutex mutex{};
+    std::condition_variable released_cv{};
+    bool released{false};
+    std::vector<float> sent_positions{};
+    bananas::mavlink::PoseSender sender{
+        [&](const mavsdk::Mocap::VisionPositionEstimate &estimate) {
+            std::unique_lock lock{mutex};
+            sent_positions.push_back(estimate.position_body.x_m);
+            // Stall the first send like a blocked MAVLink connection.
+            released_cv.wait(lock, [&released] { return released; });
+            return mavsdk::Mocap::Result::Success;
+        },
+        std::chrono::steady_clock::duration::zero()};
+
+    sender.post(estimate_at(1.0F));
+    ASSERT_TRUE(eventually([&] {
+        const std::lock_guard lock{mutex};
+        return !sent_positions.empty();
+    }));
+    sender.post(estimate_at(2.0F));
+    sender.post(estimate_at(3.0F));
+    sender.post(estimate_at(4.0F));
+    {
+        const std::lock_guard lock{mutex};
+        released = true;
+    }
+    released_cv.notify_all();
+
+    ASSERT_TRUE(
+        eventually([&sender] { return sender.statistics().sent == 2; }));
+    const auto statistics{sender.statistics()};
+    EXPECT_EQ(statistics.coalesced, std::size_t{2});
+    EXPECT_EQ(statistics.failed, std::size_t{0});
+    const std::lock_guard lock{mutex};
+    EXPECT_EQ(sent_positions, (std::vector<float>{1.0F, 4.0F}));
+}
+
+TEST(PoseSenderTest, CountsFailedSends) {
+    bananas::mavlink::PoseSender sender{
+        [](const mavsdk::Mocap::VisionPositionEstimate & /*estimate*/) {
+            return mavsdk::Mocap::Result::ConnectionError;
+        },
+        std::chrono::steady_clock::duration::zero()};
+
+    sender.post(estimate_at(1.0F));
+    ASSERT_TRUE(
+        eventually([&sender] { return sender.statistics().failed == 1; }));
+    EXPECT_EQ(sender.statistics().sent, std::size_t{0});
+}
+
+TEST(PoseSenderTest, LimitsTheSendRate) {
+    constexpr std::chrono::milliseconds min_interval{50};
+    std::mutex mutex{};
+    std::vector<std::chrono::steady_clock::time_point> send_times{};
+    bananas::mavlink::PoseSender sender{
+        [&](const mavsdk::Mocap::VisionPositionEstimate & /*estimate*/) {
+            const std::lock_guard lock{mutex};
+            send_times.push_back(std::chrono::steady_clock::now());
+            return mavsdk::Mocap::Result::Success;
+        },
+        min_interval};
+
+    sender.post(estimate_at(1.0F));
+    ASSERT_TRUE(
+        eventually([&sender] { return sender.statistics().sent == 1; }));
+    sender.post(estimate_at(2.0F));
+    ASSERT_TRUE(
+        eventually([&sender] { return sender.statistics().sent == 2; }));
+
+    const std::lock_guard lock{mutex};
+    ASSERT_EQ(send_times.size(), std::size_t{2});
+    EXPECT_GE(send_times[1] - send_times[0], min_interval);
+}
+
+TEST(PoseSenderTest, MeasuresTheAgeOfSentEstimates) {
+    bananas::mavlink::PoseSender sender{
+        [](const mavsdk::Mocap::VisionPositionEstimate & /*estimate*/) {
+            return mavsdk::Mocap::Result::Success;
+        },
+        std::chrono::steady_clock::duration::zero()};
+
+    constexpr std::chrono::milliseconds age{30};
+    auto estimate{estimate_at(1.0F)};
+    estimate.time_usec = bananas::mavlink::timestamp_usec(
+        std::chrono::steady_clock::now() - age);
+    sender.post(estimate);
+    // Estimates without a timestamp are sent but not measured.
+    ASSERT_TRUE(
+        eventually([&sender] { return sender.statistics().sent == 1; }));
+    sender.post(estimate_at(2.0F));
+    ASSERT_TRUE(
+        eventually([&sender] { return sender.statistics().sent == 2; }));
+
+    const auto ages{sender.takeAges()};
+    EXPECT_EQ(ages.count(), 1U);
+    EXPECT_GE(ages.max(), age);
+    EXPECT_EQ(sender.takeAges().count(), 0U);
+}
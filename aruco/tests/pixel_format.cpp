@@ -0,0 +1,61 @@
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include <opencv2/core/hal/interface.h>
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
+
+#include <bananas_aruco/pixel_format.h>
+
+namespace {
+
+namespace pixel_format = bananas::pixel_format;
+
+} // namespace
+
+TEST(PixelFormatTest, YuvLumaSharesThePixels) {
+    const cv::Size size{8, 4};
+    const cv::Mat frame{size.height * 3 / 2, size.width, CV_8UC1,
+                        cv::Scalar{7}};
+    cv::Mat buffer{};
+    for (const auto format :
+         {pixel_format::PixelFormat::nv12, pixel_format::PixelFormat::nv21,
+          pixel_format::PixelFormat::i420}) {
+        const auto luma{pixel_format::luma(frame, format, buffer)};
+        EXPECT_EQ(luma.size(), size);
+        EXPECT_EQ(luma.data, frame.data);
+    }
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(PixelFormatTest, GrayLumaSharesThePixels) {
+    const cv::Mat frame{4, 8, CV_8UC1, cv::Scalar{7}};
+    cv::Mat buffer{};
+    const auto luma{
+        pixel_format::luma(frame, pixel_format::PixelFormat::gray, buffer)};
+    EXPECT_EQ(luma.data, frame.data);
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(PixelFormatTest, BgrLumaIsConverted) {
+    const cv::Mat frame{4, 8, CV_8UC3, cv::Scalar{100, 100, 100}};
+    cv::Mat buffer{};
+    const auto luma{
+        pixel_format::luma(frame, pixel_format::PixelFormat::bgr, buffer)};
+    ASSERT_EQ(luma.type(), CV_8UC1);
+    EXPECT_EQ(luma.size(), frame.size());
+    EXPECT_EQ(luma.at<std::uint8_t>(2, 3), 100);
+}
+
+TEST(PixelFormatTest, ConvertsToBgr) {
+    const cv::Mat frame{6, 8, CV_8UC1, cv::Scalar{128}};
+    cv::Mat bgr{};
+    pixel_format::to_bgr(frame, pixel_format::PixelFormat::nv12, bgr);
+    EXPECT_EQ(bgr.type(), CV_8UC3);
+    EXPECT_EQ(bgr.size(), cv::Size(8, 4));
+
+    pixel_format::to_bgr(frame, pixel_format::PixelFormat::gray, bgr);
+    EXPECT_EQ(bgr.type(), CV_8UC3);
+    EXPECT_EQ(bgr.size(), frame.size());
+}
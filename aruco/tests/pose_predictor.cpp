@@ -0,0 +1,115 @@
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/pose_predictor.h>
+#include <bananas_aruco/world.h>
+
+// LINT: gtest macros quickly bump this metric up.
+// NOLINTBEGIN(readability-function-cognitive-complexity)
+
+namespace {
+
+namespace pose_predictor = bananas::pose_predictor;
+namespace world = bananas::world;
+
+using std::chrono::milliseconds;
+
+constexpr float error_bound{1E-5};
+
+auto pose(float x, float yaw) -> world::UncertainPose {
+    return {0.5F,
+            {Eigen::Quaternionf{
+                 Eigen::AngleAxisf{yaw, Eigen::Vector3f::UnitY()}},
+             {x, 1.0F, 0.0F}}};
+}
+
+void expect_pose_near(const world::UncertainPose &actual,
+                      const world::UncertainPose &expected) {
+    EXPECT_TRUE(actual.placement.getTranslation().isApprox(
+        expected.placement.getTranslation(), error_bound))
+        << actual.placement.getTranslation().transpose();
+    EXPECT_NEAR(actual.placement.getRotation().angularDistance(
+                    expected.placement.getRotation()),
+                0.0F, error_bound);
+    EXPECT_FLOAT_EQ(actual.reprojection_error, expected.reprojection_error);
+}
+
+} // namespace
+
+TEST(PosePredictorTest, PredictsNothingWithoutMeasurements) {
+    const pose_predictor::PosePredictor predictor{};
+    EXPECT_FALSE(predictor.predict(pose_predictor::Clock::now()).has_value());
+}
+
+TEST(PosePredictorTest, HoldsASingleMeasurement) {
+    pose_predictor::PosePredictor predictor{};
+    const pose_predictor::Clock::time_point start{milliseconds{1000}};
+    predictor.update(pose(1.0F, 0.5F), start);
+
+    const auto prediction{predictor.predict(start + milliseconds{50})};
+    ASSERT_TRUE(prediction.has_value());
+    expect_pose_near(*prediction, pose(1.0F, 0.5F));
+}
+
+TEST(PosePredictorTest, ExtrapolatesAtConstantVelocity) {
+    pose_predictor::PosePredictor predictor{};
+    const pose_predictor::Clock::time_point start{milliseconds{1000}};
+    // 2 m/s along x while turning at 1 rad/s.
+    predictor.update(pose(0.0F, 0.0F), start);
+    predictor.update(pose(0.1F, 0.05F), start + milliseconds{50});
+    predictor.update(pose(0.2F, 0.1F), start + milliseconds{100});
+
+    const auto prediction{predictor.predict(start + milliseconds{120})};
+    ASSERT_TRUE(prediction.has_value());
+    expect_pose_near(*prediction, pose(0.24F, 0.12F));
+
+    // Asking for a time before the latest measurement doesn't rewind.
+    const auto earlier{predictor.predict(start + milliseconds{60})};
+    ASSERT_TRUE(earlier.has_value());
+    expect_pose_near(*earlier, pose(0.2F, 0.1F));
+}
+
+TEST(PosePredictorTest, StopsPredictingPastTheHorizon) {
+    pose_predictor::PosePredictor predictor{{milliseconds{100}}};
+    const pose_predictor::Clock::time_point start{milliseconds{1000}};
+    predictor.update(pose(0.0F, 0.0F), start);
+
+    EXPECT_TRUE(predictor.predict(start + milliseconds{100}).has_value());
+    EXPECT_FALSE(predictor.predict(start + milliseconds{101}).has_value());
+
+    predictor.reset();
+    EXPECT_FALSE(predictor.predict(start).has_value());
+}
+
+TEST(PosePredictorTest, ForgetsTheVelocityAfterAGap) {
+    pose_predictor::PosePredictor predictor{
+        {milliseconds{200}, milliseconds{500}}};
+    const pose_predictor::Clock::time_point start{milliseconds{1000}};
+    predictor.update(pose(0.0F, 0.0F), start);
+    predictor.update(pose(0.1F, 0.0F), start + milliseconds{50});
+    // Tracking was lost for a second.
+    predictor.update(pose(3.0F, 0.0F), start + milliseconds{1050});
+
+    const auto prediction{predictor.predict(start + milliseconds{1100})};
+    ASSERT_TRUE(prediction.has_value());
+    expect_pose_near(*prediction, pose(3.0F, 0.0F));
+}
+
+TEST(PosePredictorTest, IgnoresStaleMeasurements) {
+    pose_predictor::PosePredictor predictor{};
+    const pose_predictor::Clock::time_point start{milliseconds{1000}};
+    predictor.update(pose(0.0F, 0.0F), start);
+    predictor.update(pose(0.1F, 0.0F), start + milliseconds{50});
+    predictor.update(pose(5.0F, 0.0F), start + milliseconds{20});
+
+    const auto prediction{predictor.predict(start + milliseconds{100})};
+    ASSERT_TRUE(prediction.has_value());
+    expect_pose_near(*prediction, pose(0.2F, 0.0F));
+}
+
+// NOLINTEND(readability-function-cognitive-complexity)
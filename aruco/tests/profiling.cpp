@@ -0,0 +1,84 @@
+#include <chrono>
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include <bananas_aruco/profiling.h>
+
+// LINT: gtest macros quickly bump this metric up.
+// NOLINTBEGIN(readability-function-cognitive-complexity)
+
+namespace {
+
+namespace profiling = bananas::profiling;
+
+using std::chrono::microseconds;
+using std::chrono::nanoseconds;
+
+} // namespace
+
+TEST(LatencyHistogramTest, EmptyHistogram) {
+    const profiling::LatencyHistogram histogram{};
+    EXPECT_EQ(histogram.count(), std::uint64_t{0});
+    EXPECT_EQ(histogram.max(), profiling::Clock::duration::zero());
+    EXPECT_EQ(histogram.percentile(0.5), profiling::Clock::duration::zero());
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+    profiling::LatencyHistogram histogram{};
+    for (int i{1}; i <= 10; ++i) {
+        histogram.record(nanoseconds{i});
+    }
+    EXPECT_EQ(histogram.count(), std::uint64_t{10});
+    EXPECT_EQ(histogram.percentile(0.5), nanoseconds{5});
+    EXPECT_EQ(histogram.percentile(0.0), nanoseconds{1});
+    EXPECT_EQ(histogram.percentile(1.0), nanoseconds{10});
+    EXPECT_EQ(histogram.max(), nanoseconds{10});
+}
+
+TEST(LatencyHistogramTest, PercentilesHaveBoundedError) {
+    profiling::LatencyHistogram histogram{};
+    for (int i{1}; i <= 1000; ++i) {
+        histogram.record(microseconds{i});
+    }
+    const auto within = [](profiling::Clock::duration actual,
+                           profiling::Clock::duration expected) {
+        return actual >= expected && actual <= expected + expected / 16;
+    };
+    EXPECT_TRUE(within(histogram.percentile(0.5), microseconds{500}));
+    EXPECT_TRUE(within(histogram.percentile(0.99), microseconds{990}));
+    EXPECT_EQ(histogram.percentile(1.0), microseconds{1000});
+    EXPECT_EQ(histogram.max(), microseconds{1000});
+}
+
+TEST(LatencyHistogramTest, WritesJson) {
+    profiling::LatencyHistogram histogram{};
+    histogram.record(microseconds{1500});
+    histogram.record(microseconds{2000});
+
+    const nlohmann::json json(histogram);
+    EXPECT_EQ(json.at("count"), 2);
+    EXPECT_DOUBLE_EQ(json.at("max_ms").get<double>(), 2.0);
+    EXPECT_GE(json.at("p50_ms").get<double>(), 1.5);
+    EXPECT_LE(json.at("p50_ms").get<double>(), 1.6);
+}
+
+TEST(FitProfileTest, TimesStages) {
+    profiling::FitProfile profile{};
+    {
+        const auto timer{profile.time(profiling::Stage::detect)};
+        const auto board_timer{profile.timeBoard(3)};
+    }
+    const nlohmann::json json(profile);
+    if constexpr (profiling::enabled) {
+        EXPECT_EQ(json.at("stages").at("detect").at("count"), 1);
+        EXPECT_EQ(json.at("stages").at("total").at("count"), 0);
+        EXPECT_EQ(json.at("boards").at("3").at("count"), 1);
+    } else {
+        EXPECT_TRUE(json.empty());
+    }
+}
+
+// NOLINTEND(readability-function-cognitive-complexity)
@@ -0,0 +1,135 @@
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
+#include <opencv2/objdetect/aruco_detector.hpp>
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/board.h>
+#include <bananas_aruco/grid_board.h>
+#include <bananas_aruco/renderer.h>
+#include <bananas_aruco/world.h>
+
+// LINT: gtest macros quickly bump this metric up.
+// NOLINTBEGIN(readability-function-cognitive-complexity)
+
+namespace {
+
+namespace affine_rotation = bananas::affine_rotation;
+namespace board = bananas::board;
+namespace renderer = bananas::renderer;
+namespace world = bananas::world;
+
+constexpr float pi{3.1415927F};
+const cv::Size image_size{1280, 720};
+
+auto camera_matrix() -> cv::Mat {
+    return (cv::Mat_<double>(3, 3) << 900.0, 0.0, 640.0, 0.0, 900.0, 360.0,
+            0.0, 0.0, 1.0);
+}
+
+/// A 3x3 grid standing 1.5 m in front of the camera and facing it.
+auto grid_to_camera() -> affine_rotation::AffineRotation {
+    return {Eigen::Quaternionf{
+                Eigen::AngleAxisf{-pi / 2.0F, Eigen::Vector3f::UnitX()}},
+            {0.1F, -0.05F, 1.5F}};
+}
+
+auto make_grid() -> board::Board {
+    return board::make_board(board::GridSettings{{3, 3}, 0.1F, 0.05F, 0});
+}
+
+} // namespace
+
+TEST(RendererTest, DrawsDetectableMarkers) {
+    const auto dictionary{
+        cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_100)};
+    const renderer::Renderer renderer{camera_matrix(), cv::Mat{}, image_size,
+                                      dictionary};
+    const auto grid{make_grid()};
+    const std::array boards{renderer::BoardPose{&grid, grid_to_camera()}};
+
+    cv::Mat image{};
+    renderer.render(boards, image);
+    ASSERT_EQ(image.size(), image_size);
+    ASSERT_EQ(image.type(), CV_8UC1);
+
+    const cv::aruco::ArucoDetector detector{dictionary};
+    std::vector<std::vector<cv::Point2f>> corners{};
+    std::vector<int> ids{};
+    detector.detectMarkers(image, corners, ids);
+    ASSERT_EQ(ids.size(), grid.marker_ids.size());
+
+    for (std::size_t i{0}; i < ids.size(); ++i) {
+        const auto id{static_cast<std::size_t>(ids[i])};
+        ASSERT_LT(id, grid.obj_points.size());
+        std::vector<cv::Point3f> expected{};
+        for (const auto &point : grid.obj_points[id]) {
+            expected.push_back(grid_to_camera() * point);
+        }
+        const auto expected_corners{renderer.project(expected)};
+        for (std::size_t j{0}; j < 4; ++j) {
+            EXPECT_LT(cv::norm(corners[i][j] - expected_corners[j]), 1.0);
+        }
+    }
+}
+
+TEST(RendererTest, SkipsMarkersFacingAway) {
+    const auto dictionary{
+        cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_100)};
+    const renderer::Renderer renderer{camera_matrix(), cv::Mat{}, image_size,
+                                      dictionary, {100.0, 0.0, 0.0}};
+    const auto grid{make_grid()};
+    const affine_rotation::AffineRotation turned_around{
+        Eigen::Quaternionf{Eigen::AngleAxisf{pi, Eigen::Vector3f::UnitY()}},
+        Eigen::Vector3f::Zero()};
+    const std::array boards{
+        renderer::BoardPose{&grid, grid_to_camera() * turned_around}};
+
+    cv::Mat image{};
+    renderer.render(boards, image);
+    EXPECT_EQ(cv::countNonZero(image != 100), 0);
+}
+
+TEST(RendererTest, WorldFindsRenderedCamera) {
+    const auto dictionary{
+        cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_100)};
+    const cv::Mat distortion{
+        (cv::Mat_<double>(1, 5) << -0.2, 0.05, 0.0, 0.0, 0.0)};
+    const renderer::Renderer renderer{camera_matrix(), distortion, image_size,
+                                      dictionary, {200.0, 0.8, 2.0}};
+    const auto grid{make_grid()};
+
+    // Place the camera somewhere in the world and the grid relative to it.
+    const affine_rotation::AffineRotation camera_to_world{
+        Eigen::Quaternionf{
+            Eigen::AngleAxisf{0.3F, Eigen::Vector3f::UnitY()}},
+        {1.0F, 1.5F, -2.0F}};
+    const std::array boards{renderer::BoardPose{&grid, grid_to_camera()}};
+    cv::Mat image{};
+    renderer.render(boards, image);
+
+    world::World world{camera_matrix(), distortion, dictionary};
+    world.makeStatic(world.addBoard(grid), camera_to_world * grid_to_camera());
+    const auto result{world.fit(image)};
+    ASSERT_TRUE(result.camera_to_world.has_value());
+
+    const auto &found{result.camera_to_world->placement};
+    EXPECT_LT((found.getTranslation() - camera_to_world.getTranslation())
+                  .norm(),
+              0.01F);
+    EXPECT_LT(found.getRotation().angularDistance(
+                  camera_to_world.getRotation()),
+              0.01F);
+}
+
+// NOLINTEND(readability-function-cognitive-complexity)
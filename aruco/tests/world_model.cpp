@@ -0,0 +1,136 @@
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+
+#include <bananas_aruco/affine_rotation.h>
+#include <bananas_aruco/board.h>
+#include <bananas_aruco/grid_board.h>
+#include <bananas_aruco/pixel_format.h>
+#include <bananas_aruco/renderer.h>
+#include <bananas_aruco/world.h>
+
+// LINT: gtest macros quickly bump this metric up.
+// NOLINTBEGIN(readability-function-cognitive-complexity)
+
+namespace {
+
+namespace affine_rotation = bananas::affine_rotation;
+namespace board = bananas::board;
+namespace pixel_format = bananas::pixel_format;
+namespace renderer = bananas::renderer;
+namespace world = bananas::world;
+
+constexpr float pi{3.1415927F};
+const cv::Size image_size{1280, 720};
+
+auto camera_matrix() -> cv::Mat {
+    return (cv::Mat_<double>(3, 3) << 900.0, 0.0, 640.0, 0.0, 900.0, 360.0,
+            0.0, 0.0, 1.0);
+}
+
+/// A 3x3 grid standing @p distance metres in front of the camera.
+auto grid_to_camera(float distance) -> affine_rotation::AffineRotation {
+    return {Eigen::Quaternionf{
+                Eigen::AngleAxisf{-pi / 2.0F, Eigen::Vector3f::UnitX()}},
+            {0.1F, -0.05F, distance}};
+}
+
+auto make_grid(int first_marker) -> board::Board {
+    return board::make_board(
+        board::GridSettings{{3, 3}, 0.1F, 0.05F, first_marker});
+}
+
+} // namespace
+
+TEST(WorldModelTest, WorldsShareTheModel) {
+    const auto dictionary{
+        cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_100)};
+    const renderer::Renderer renderer{camera_matrix(), cv::Mat{}, image_size,
+                                      dictionary};
+    const auto grid{make_grid(0)};
+    const affine_rotation::AffineRotation grid_to_world{};
+
+    auto model{std::make_shared<world::WorldModel>(dictionary)};
+    model->makeStatic(model->addBoard(grid), grid_to_world);
+    // A dynamic board added after the static one, so that its ID is not the
+    // only one.
+    model->addBoard(make_grid(9));
+    EXPECT_EQ(model->boardCount(), std::size_t{2});
+    EXPECT_TRUE(model->staticMarkerOffset(0).has_value());
+    EXPECT_FALSE(model->staticMarkerOffset(1).has_value());
+
+    // Each World sees the grid from a different distance and tracks it on its
+    // own thread.
+    constexpr std::array distances{1.2F, 2.0F};
+    constexpr int frame_count{5};
+    std::array<std::optional<world::UncertainPose>, distances.size()>
+        found{};
+    std::vector<std::thread> threads{};
+    for (std::size_t i{0}; i < distances.size(); ++i) {
+        cv::Mat image{};
+        const std::array boards{
+            renderer::BoardPose{&grid, grid_to_camera(distances[i])}};
+        renderer.render(boards, image);
+        threads.emplace_back([&model, &found, i, image] {
+            world::World world{model, camera_matrix(), cv::Mat{}};
+            world::FitWorkspace workspace{};
+            world::FitResult result{};
+            for (int frame{0}; frame < frame_count; ++frame) {
+                world.fit(image, pixel_format::PixelFormat::gray, workspace,
+                          result);
+            }
+            found[i] = result.camera_to_world;
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    for (std::size_t i{0}; i < distances.size(); ++i) {
+        ASSERT_TRUE(found[i].has_value());
+        const auto expected{grid_to_world *
+                            grid_to_camera(distances[i]).inverse()};
+        EXPECT_LT((found[i]->placement.getTranslation() -
+                   expected.getTranslation())
+                      .norm(),
+                  0.01F);
+    }
+}
+
+TEST(WorldModelTest, ModelRejectsClashingBoards) {
+    const auto dictionary{
+        cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_100)};
+    world::WorldModel model{dictionary};
+    model.addBoard(make_grid(0));
+    EXPECT_THROW(model.addBoard(make_grid(4)), std::invalid_argument);
+    EXPECT_EQ(model.boardCount(), std::size_t{1});
+}
+
+TEST(WorldModelTest, ModelRejectsStaticPlacementsOfMissingBoards) {
+    const auto dictionary{
+        cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_100)};
+    world::WorldModel model{dictionary};
+    model.addBoard(make_grid(0));
+    const std::array placements{
+        std::pair{world::BoardId{0}, affine_rotation::AffineRotation{}},
+        std::pair{world::BoardId{1}, affine_rotation::AffineRotation{}}};
+    EXPECT_THROW(model.makeStatic(placements), std::invalid_argument);
+    // Nothing is moved when one of the boards is missing.
+    EXPECT_FALSE(model.staticMarkerOffset(0).has_value());
+}
+
+// NOLINTEND(readability-function-cognitive-complexity)